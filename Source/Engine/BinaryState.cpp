@@ -0,0 +1,221 @@
+/*
+  ==============================================================================
+
+    BinaryState.cpp
+    Created: 17 Oct 2026 11:58:37pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "BinaryState.h"
+#include <cstring>
+#include <utility>
+
+namespace
+{
+const std::size_t HeaderSize = 8;
+const std::size_t ParameterSize = 8;
+const std::size_t DeliverySize = 9;
+const std::size_t LearnedControlSize = 5;
+const std::size_t PresetBankSize = 1 + 2 * LearnedControlSize;
+const std::size_t MaxBlockSizeSize = 4;
+
+class Writer
+{
+public:
+    explicit Writer(std::uint8_t* destination) : position(destination) {}
+
+    void Write(std::uint32_t value, int numBytes)
+    {
+        for(int i=0;i<numBytes;i++)
+        {
+            *position++ = (std::uint8_t) (value >> (8 * i));
+        }
+    }
+    void WriteFloat(float value)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        Write(bits, 4);
+    }
+    void WriteControl(const LearnedControl& control)
+    {
+        for(auto value : {control.messageType, control.channel, control.number, control.minValue, control.maxValue})
+        {
+            Write((std::uint32_t) value, 1);
+        }
+    }
+    void WriteBytes(const void* data, std::size_t size)
+    {
+        Write((std::uint32_t) size, 2);
+        if(size > 0) std::memcpy(position, data, size);
+        position += size;
+    }
+
+private:
+    std::uint8_t* position;
+};
+
+class Reader
+{
+public:
+    Reader(const void* data, std::size_t size) : position(static_cast<const std::uint8_t*>(data)), end(position + size) {}
+
+    bool Read(std::uint32_t& value, int numBytes)
+    {
+        if(end - position < numBytes) return false;
+        value = 0;
+        for(int i=0;i<numBytes;i++)
+        {
+            value |= (std::uint32_t) *position++ << (8 * i);
+        }
+        return true;
+    }
+    bool ReadFloat(float& value)
+    {
+        std::uint32_t bits;
+        if(! Read(bits, 4)) return false;
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+    bool ReadControl(LearnedControl& control)
+    {
+        std::uint32_t values[LearnedControlSize];
+        for(auto& value : values)
+        {
+            if(! Read(value, 1)) return false;
+        }
+        control = {(int) values[0], (int) values[1], (int) values[2], (int) values[3], (int) values[4]};
+        return true;
+    }
+    bool ReadBytes(const std::uint8_t*& data, std::size_t& size)
+    {
+        std::uint32_t length;
+        if(! Read(length, 2) || (std::size_t) (end - position) < length) return false;
+        data = position;
+        size = length;
+        position += length;
+        return true;
+    }
+
+private:
+    const std::uint8_t* position;
+    const std::uint8_t* end;
+};
+}
+
+//==============================================================================
+bool BinaryState::IsBinaryState(const void* data, std::size_t size)
+{
+    std::uint32_t magic;
+    return data != nullptr && Reader(data, size).Read(magic, 4) && magic == Magic;
+}
+
+std::size_t BinaryState::GetSize() const
+{
+    return HeaderSize + parameters.size() * ParameterSize
+         + 2 + chordBuilds.size()
+         + DeliverySize
+         + 2 + presetName.size()
+         + 2 + pluginVersion.size()
+         + PresetBankSize
+         + MaxBlockSizeSize;
+}
+
+void BinaryState::Write(std::uint8_t* destination) const
+{
+    Writer writer(destination);
+    writer.Write(Magic, 4);
+    writer.Write(FormatVersion, 2);
+    writer.Write((std::uint32_t) parameters.size(), 2);
+    for(const auto& parameter : parameters)
+    {
+        writer.Write(parameter.idHash, 4);
+        writer.WriteFloat(parameter.value);
+    }
+    writer.WriteBytes(chordBuilds.data(), chordBuilds.size());
+    writer.Write((std::uint32_t) deliveryPolicy.mode, 1);
+    writer.Write((std::uint32_t) deliveryPolicy.eventsPerBlock, 4);
+    writer.Write((std::uint32_t) deliveryPolicy.spreadSamples, 4);
+    writer.WriteBytes(presetName.data(), presetName.size());
+    writer.WriteBytes(pluginVersion.data(), pluginVersion.size());
+    writer.Write(presetBank.enabled ? 1 : 0, 1);
+    writer.WriteControl(presetBank.next);
+    writer.WriteControl(presetBank.previous);
+    writer.Write((std::uint32_t) deliveryPolicy.maxBlockSize, 4);
+}
+
+bool BinaryState::Read(const void* data, std::size_t size)
+{
+    if(! IsBinaryState(data, size))
+    {
+        return false;
+    }
+    Reader reader(data, size);
+    std::uint32_t magic, version, numParameters;
+    if(! reader.Read(magic, 4) || ! reader.Read(version, 2) || version < 1 || version > FormatVersion || ! reader.Read(numParameters, 2))
+    {
+        return false;
+    }
+
+    BinaryState state;
+    state.parameters.resize(numParameters);
+    for(auto& parameter : state.parameters)
+    {
+        if(! reader.Read(parameter.idHash, 4) || ! reader.ReadFloat(parameter.value))
+        {
+            return false;
+        }
+    }
+
+    const std::uint8_t* bytes;
+    std::size_t length;
+    if(! reader.ReadBytes(bytes, length))
+    {
+        return false;
+    }
+    state.chordBuilds.assign(bytes, bytes + length);
+
+    std::uint32_t mode, eventsPerBlock, spreadSamples;
+    if(! reader.Read(mode, 1) || ! reader.Read(eventsPerBlock, 4) || ! reader.Read(spreadSamples, 4))
+    {
+        return false;
+    }
+    state.deliveryPolicy.mode = (DeliveryMode) (mode > 2 ? 0 : mode);
+    state.deliveryPolicy.eventsPerBlock = (int) eventsPerBlock;
+    state.deliveryPolicy.spreadSamples = (int) spreadSamples;
+
+    if(! reader.ReadBytes(bytes, length))
+    {
+        return false;
+    }
+    state.presetName.assign(reinterpret_cast<const char*>(bytes), length);
+    if(! reader.ReadBytes(bytes, length))
+    {
+        return false;
+    }
+    state.pluginVersion.assign(reinterpret_cast<const char*>(bytes), length);
+
+    if(version >= 2)
+    {
+        std::uint32_t enabled;
+        if(! reader.Read(enabled, 1) || ! reader.ReadControl(state.presetBank.next) || ! reader.ReadControl(state.presetBank.previous))
+        {
+            return false;
+        }
+        state.presetBank.enabled = enabled != 0;
+    }
+    if(version >= 3)
+    {
+        std::uint32_t maxBlockSize;
+        if(! reader.Read(maxBlockSize, 4))
+        {
+            return false;
+        }
+        state.deliveryPolicy.maxBlockSize = (int) maxBlockSize;
+    }
+
+    *this = std::move(state);
+    return true;
+}
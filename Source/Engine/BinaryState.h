@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    BinaryState.h
+    Created: 17 Oct 2026 11:58:37pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DeliveryScheduler.h"
+#include "PresetBank.h"
+
+//==============================================================================
+// The plugin state as written by getStateInformation. Hosts save it with
+// every autosave, so it is written straight from the parameter values,
+// without the xml of the parameter tree. Little endian:
+//
+//   uint32 Magic ("RTNB"), uint16 FormatVersion, uint16 number of parameters
+//   per parameter: uint32 HashID of the parameter id, float value (not normalised)
+//   uint16 size, packed chord builds (ChordBuilds::ToBytes)
+//   uint8 delivery mode, int32 events per block, int32 spread samples
+//   uint16 size, preset name (utf-8)
+//   uint16 size, version of the plugin that wrote the state
+//   since format 2: uint8 preset bank enabled, the next and previous controls
+//   of the bank (uint8 message type, channel, number, min value, max value)
+//   since format 3: int32 max block size of the delivery policy
+//
+// Parameters are found by the hash of their id, so a state can still be read
+// when parameters are added, removed or reordered. States that do not start
+// with the magic are the xml states of older versions.
+//==============================================================================
+struct BinaryState
+{
+    static const std::uint32_t Magic = 0x424e5452; // "RTNB"
+    static const int FormatVersion = 3;
+
+    struct ParameterValue
+    {
+        std::uint32_t idHash;
+        float value;
+    };
+
+    std::vector<ParameterValue> parameters;
+    std::vector<std::uint8_t> chordBuilds;
+    DeliveryPolicy deliveryPolicy;
+    std::string presetName;
+    std::string pluginVersion;
+    PresetBankSettings presetBank;
+
+    // 32 bit FNV-1a
+    static constexpr std::uint32_t HashID(const char* id)
+    {
+        std::uint32_t hash = 2166136261u;
+        for(;*id != 0;id++)
+        {
+            hash = (hash ^ (std::uint8_t) *id) * 16777619u;
+        }
+        return hash;
+    }
+
+    static bool IsBinaryState(const void* data, std::size_t size);
+
+    std::size_t GetSize() const;
+    // writes GetSize() bytes
+    void Write(std::uint8_t* destination) const;
+    // reads the formats up to FormatVersion. Returns false when the data is not a binary state
+    // of a known version. Nothing is changed then.
+    bool Read(const void* data, std::size_t size);
+};
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    ChordBuilds.cpp
+    Created: 17 Oct 2026 11:02:18pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "ChordBuilds.h"
+#include <cstring>
+
+namespace
+{
+const char* const base64Characters = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const int HeaderSize = 4; // version, progressions, zones, notes
+
+std::string ToBase64(const std::vector<std::uint8_t>& bytes)
+{
+    std::string text;
+    text.reserve((bytes.size() + 2) / 3 * 4);
+    for(std::size_t i=0;i<bytes.size();i+=3)
+    {
+        std::uint32_t block = (std::uint32_t) bytes[i] << 16;
+        if(i + 1 < bytes.size()) block |= (std::uint32_t) bytes[i + 1] << 8;
+        if(i + 2 < bytes.size()) block |= bytes[i + 2];
+        text += base64Characters[(block >> 18) & 0x3f];
+        text += base64Characters[(block >> 12) & 0x3f];
+        text += i + 1 < bytes.size() ? base64Characters[(block >> 6) & 0x3f] : '=';
+        text += i + 2 < bytes.size() ? base64Characters[block & 0x3f] : '=';
+    }
+    return text;
+}
+
+bool FromBase64(const std::string& text, std::vector<std::uint8_t>& bytes)
+{
+    bytes.clear();
+    std::uint32_t block = 0;
+    int bits = 0;
+    for(auto character : text)
+    {
+        int value;
+        if(character >= 'A' && character <= 'Z') value = character - 'A';
+        else if(character >= 'a' && character <= 'z') value = character - 'a' + 26;
+        else if(character >= '0' && character <= '9') value = character - '0' + 52;
+        else if(character == '+') value = 62;
+        else if(character == '/') value = 63;
+        else if(character == '=') break;
+        else return false;
+        block = (block << 6) | (std::uint32_t) value;
+        bits += 6;
+        if(bits >= 8)
+        {
+            bits -= 8;
+            bytes.push_back((std::uint8_t) (block >> bits));
+        }
+    }
+    return true;
+}
+}
+
+//==============================================================================
+ChordBuilds ChordBuilds::CreateDefault()
+{
+    ChordBuilds builds;
+    for(int prog=0;prog<MAX_PROGRESSIONS;prog++)
+    {
+        for(int zone=0;zone<MAX_ZONES;zone++)
+        {
+            for(int note=0;note<MAX_NOTES;note++)
+            {
+                builds.intervals[prog][zone][note] = (std::int8_t) (note == 0 ? 0 : NONOTE);
+            }
+        }
+    }
+    return builds;
+}
+
+void ChordBuilds::Set(int progression, int zone, int note, int interval)
+{
+    if(interval != NONOTE)
+    {
+        interval = interval < MinInterval ? MinInterval : interval > MaxInterval ? MaxInterval : interval;
+    }
+    intervals[progression][zone][note] = (std::int8_t) interval;
+}
+
+std::string ChordBuilds::ToState() const
+{
+    return ToBase64(ToBytes());
+}
+
+bool ChordBuilds::FromState(const std::string& state)
+{
+    std::vector<std::uint8_t> bytes;
+    return FromBase64(state, bytes) && FromBytes(bytes.data(), bytes.size());
+}
+
+std::vector<std::uint8_t> ChordBuilds::ToBytes() const
+{
+    std::vector<std::uint8_t> bytes(HeaderSize + sizeof(intervals));
+    bytes[0] = (std::uint8_t) StateVersion;
+    bytes[1] = MAX_PROGRESSIONS;
+    bytes[2] = MAX_ZONES;
+    bytes[3] = MAX_NOTES;
+    std::memcpy(bytes.data() + HeaderSize, intervals, sizeof(intervals));
+    return bytes;
+}
+
+bool ChordBuilds::FromBytes(const std::uint8_t* bytes, std::size_t size)
+{
+    if(size < HeaderSize || bytes[0] != StateVersion)
+    {
+        return false;
+    }
+    int numProgressions = bytes[1], numZones = bytes[2], numNotes = bytes[3];
+    if(size != (std::size_t) (HeaderSize + numProgressions * numZones * numNotes))
+    {
+        return false;
+    }
+    // a state with other dimensions is copied as far as they overlap, the rest keeps its default
+    auto builds = CreateDefault();
+    for(int prog=0;prog<numProgressions && prog<MAX_PROGRESSIONS;prog++)
+    {
+        for(int zone=0;zone<numZones && zone<MAX_ZONES;zone++)
+        {
+            for(int note=0;note<numNotes && note<MAX_NOTES;note++)
+            {
+                builds.intervals[prog][zone][note] = (std::int8_t) bytes[(std::size_t) (HeaderSize + (prog * numZones + zone) * numNotes + note)];
+            }
+        }
+    }
+    *this = builds;
+    return true;
+}
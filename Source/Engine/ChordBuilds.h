@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    ChordBuilds.h
+    Created: 17 Oct 2026 11:02:18pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "EngineDefines.h"
+
+//==============================================================================
+// The chord builds of all progressions and zones: intervals relative to the
+// key of the zone, NONOTE for notes that are not used. A chord ends at the
+// first NONOTE.
+//
+// The chord builds are not plugin parameters. They are kept as one property
+// of the plugin state (CHORDBUILDS_ID), in the packed form of ToState:
+// base64 of a version byte, the three dimensions and one int8 per interval.
+// The binary plugin state (BinaryState) holds the same bytes without base64.
+//==============================================================================
+struct alignas(64) ChordBuilds
+{
+    static const int StateVersion = 1;
+    static const int MinInterval = -127;
+    static const int MaxInterval = 127;
+
+    std::int8_t intervals[MAX_PROGRESSIONS][MAX_ZONES][MAX_NOTES];
+
+    // only the base note in every zone
+    static ChordBuilds CreateDefault();
+
+    int Get(int progression, int zone, int note) const { return intervals[progression][zone][note]; }
+    // values outside of the interval range are clamped, NONOTE is kept
+    void Set(int progression, int zone, int note, int interval);
+
+    std::string ToState() const;
+    // returns false when the text is not a chord build state of a known version. Nothing is changed then.
+    bool FromState(const std::string& state);
+
+    // the packed bytes of the state, before base64
+    std::vector<std::uint8_t> ToBytes() const;
+    bool FromBytes(const std::uint8_t* bytes, std::size_t size);
+};
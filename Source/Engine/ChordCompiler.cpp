@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    ChordCompiler.cpp
+    Created: 17 Oct 2026 10:05:51am
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "ChordCompiler.h"
+
+void ChordCompiler::Compile(const ChordSettings& settings, ChordTable& table)
+{
+    for(int prog=0;prog<MAX_PROGRESSIONS;prog++)
+    {
+        CompileProgression(settings, prog, table);
+    }
+}
+
+void ChordCompiler::CompileProgression(const ChordSettings& settings, int progression, ChordTable& table)
+{
+    int maxNote = 0;
+    int key = 0;
+    int octave = settings.octave;
+    int addOctaves=0;
+
+    for(int zone=0 ; zone < MAX_ZONES; zone++)
+    {
+        key = settings.keys[progression][zone];
+
+        //pitchMode 0 = up
+        if(settings.pitchMode == 0)
+        {
+            //if the notevalue is lower then the highest note, just add an octave to it.
+            if(key <= maxNote && (key + ( octave + addOctaves + 1) * 12) < 128)
+            {
+                addOctaves++;
+            }
+            maxNote = key;
+        }
+        GetNoteNumbersForChord(settings, octave + addOctaves, progression, zone, key, table);
+    }
+}
+
+int ChordCompiler::GetRelativeNoteNumber(const ChordSettings& settings, int progression, int selectedzone, int notenumber)
+{
+    int maxNote = 0;
+    int key = 0;
+    int octave = settings.octave;
+    int addOctaves=0;
+
+    for(int zone=0 ; zone < MAX_ZONES; zone++)
+    {
+        key = settings.keys[progression][zone];
+
+        //pitchMode 0 = up
+        if(settings.pitchMode == 0)
+        {
+            //if the notevalue is lower then the highest note, just add an octave to it.
+            if(key <= maxNote && (key + ( octave + addOctaves + 1) * 12) < 128)
+            {
+                addOctaves++;
+            }
+            maxNote = key;
+        }
+        if(zone == selectedzone)
+        {
+            break;
+        }
+    }
+    int keynote = key + 24 - 1 + (octave + addOctaves) * 12; //Since addoctaves starts at -2, offset for key is -24. Also there is an offset of +1, because C corresponds to 1 in the list instead of 0. Both are corrected here.
+    int notediff = notenumber - keynote;
+    if(notediff > -128 && notediff < 128)
+    {
+        return notediff;
+    }
+    else
+    {
+        return NONOTE;
+    }
+}
+
+// calculate the notes to be played for a specific zone
+// since key equals to one instead of zero, the counting is a bit strange
+void ChordCompiler::GetNoteNumbersForChord(const ChordSettings& settings, int addOctaves, int progression, int zone, int key, ChordTable& table)
+{
+    for(int note=0;note<MAX_NOTES;note++)
+    {
+        int notenr = settings.chordNotes.Get(progression, zone, note);
+        if(notenr != NONOTE)
+        {
+            int keynote = key + 24 - 1; //Since addoctaves starts at -2, offset for key is -24. Also there is an offset of +1, because C corresponds to 1 in the list instead of 0. Both are corrected here.
+            if(keynote + notenr > 8 && addOctaves > 7) addOctaves = 7; //do not go past G8
+            notenr = keynote + notenr + addOctaves * 12;
+            //keep the note in the midi range
+            notenr = notenr < 0 ? 0 : notenr > 127 ? 127 : notenr;
+        }
+        table.notes[progression][zone][note] = (std::int8_t) notenr;
+    }
+}
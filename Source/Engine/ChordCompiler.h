@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    ChordCompiler.h
+    Created: 17 Oct 2026 10:05:51am
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include "EngineDefines.h"
+#include "ChordBuilds.h"
+
+//==============================================================================
+// The settings the notes to play are calculated from.
+//==============================================================================
+struct ChordSettings
+{
+    int keys[MAX_PROGRESSIONS][MAX_ZONES];                  // 1 = C, 12 = B
+    ChordBuilds chordNotes;                                 // intervals relative to the key, NONOTE if not used
+    int octave;
+    int pitchMode;                                          // 0 = up, 1 = in octave
+};
+
+//==============================================================================
+// Flat table with the midi note numbers to play for each progression and zone.
+// A chord ends at the first NONOTE. The notes of one chord are 12 bytes in
+// one cache line.
+//==============================================================================
+struct alignas(64) ChordTable
+{
+    std::int8_t notes[MAX_PROGRESSIONS][MAX_ZONES][MAX_NOTES];
+};
+
+//==============================================================================
+// Calculates the notes to play from the selected keys, chord builds, octave and
+// pitch mode.
+//==============================================================================
+class ChordCompiler
+{
+public:
+    static void Compile(const ChordSettings& settings, ChordTable& table);
+    static void CompileProgression(const ChordSettings& settings, int progression, ChordTable& table);
+
+    // interval of the notenumber relative to the key of the zone. Used to learn chords from played notes.
+    static int GetRelativeNoteNumber(const ChordSettings& settings, int progression, int selectedzone, int notenumber);
+
+private:
+    static void GetNoteNumbersForChord(const ChordSettings& settings, int addOctaves, int progression, int zone, int key, ChordTable& table);
+};
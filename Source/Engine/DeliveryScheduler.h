@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    DeliveryScheduler.h
+    Created: 17 Oct 2026 4:27:18pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "EngineDefines.h"
+#include "MidiEventQueue.h"
+
+//==============================================================================
+// How the generated midi is handed to the host.
+// allAtOnce        every event is played at the sample it was created.
+// eventsPerBlock   at most eventsPerBlock events are played per block, the
+//                  rest is played in the next blocks. Needed for hosts that
+//                  do not accept multiple messages in one buffer (Blue Cat's
+//                  Patchwork). When maxBlockSize is set, only blocks up to
+//                  that many samples are limited, larger blocks get every
+//                  event at once.
+// spreadOverSamples the events of a chord change are spaced out, so that the
+//                  last one is played at most spreadSamples after the first.
+//==============================================================================
+enum class DeliveryMode { allAtOnce = 0, eventsPerBlock, spreadOverSamples };
+
+struct DeliveryPolicy
+{
+    DeliveryMode mode = DeliveryMode::allAtOnce;
+    int eventsPerBlock = 1;
+    int spreadSamples = 64;
+    int maxBlockSize = 0; // eventsPerBlock: largest block that is limited, 0 = every block
+};
+
+// most events one chord change can create: a note on and two note offs per note
+const int MAX_EVENTS_PER_CHANGE = 3 * MAX_NOTES;
+
+//==============================================================================
+// Takes the events from the queue that have to be played in the current block.
+// Events that have to wait stay in the queue with a negative sample position,
+// which is how late they are. That way the delay every event gets is known,
+// and the largest one is kept as the measured delivery latency.
+//==============================================================================
+class DeliveryScheduler
+{
+public:
+    void setPolicy(const DeliveryPolicy& newPolicy)
+    {
+        policy = newPolicy;
+        if(policy.eventsPerBlock < 1) policy.eventsPerBlock = 1;
+        if(policy.spreadSamples < 0) policy.spreadSamples = 0;
+    }
+    const DeliveryPolicy& getPolicy() const { return policy; }
+    // true when not every event of a block of this size is played in the block
+    bool holdsBackEvents(int numSamples) const
+    {
+        return policy.mode == DeliveryMode::eventsPerBlock && isLimited(policy, numSamples);
+    }
+    // the largest delay the policy gives an event of a chord change in blocks of this size, in samples.
+    // Queued note ons are dropped when their notes stop, so the queue never holds more than one change
+    // and deliver never returns more than this.
+    static int getLatencySamples(const DeliveryPolicy& policy, int numSamples)
+    {
+        switch(policy.mode)
+        {
+            case DeliveryMode::eventsPerBlock:
+            {
+                if(! isLimited(policy, numSamples)) return 0;
+                const auto eventsPerBlock = policy.eventsPerBlock < 1 ? 1 : policy.eventsPerBlock;
+                const auto blocks = (MAX_EVENTS_PER_CHANGE + eventsPerBlock - 1) / eventsPerBlock;
+                return (blocks - 1) * numSamples;
+            }
+            case DeliveryMode::spreadOverSamples:
+                return GetSpacing(policy) * (MAX_EVENTS_PER_CHANGE - 1);
+            case DeliveryMode::allAtOnce:
+            default:
+                return 0;
+        }
+    }
+
+    // calls output(event, samplePosition) for every event that is played in this block.
+    // Returns the largest delay of the played events in samples.
+    template <typename Output>
+    int deliver(MidiEventQueue& queue, int numSamples, Output&& output)
+    {
+        int maxDelay = 0;
+        int played = 0;
+        const bool limited = policy.mode == DeliveryMode::eventsPerBlock && isLimited(policy, numSamples);
+        int nextFreeSample = nextFreeSampleCarry;
+        while(! queue.isEmpty())
+        {
+            const auto& event = queue.front();
+            int position = event.samplePosition > 0 ? event.samplePosition : 0;
+
+            if(limited && played >= policy.eventsPerBlock) break;
+            if(policy.mode == DeliveryMode::spreadOverSamples && position < nextFreeSample)
+            {
+                position = nextFreeSample;
+            }
+            if(position >= numSamples) break;
+
+            MidiEvent next;
+            queue.pop(next);
+            output(next, position);
+            maxDelay = position - next.samplePosition > maxDelay ? position - next.samplePosition : maxDelay;
+            nextFreeSample = position + GetSpacing(policy);
+            played++;
+        }
+        // the events that are left are played in the next blocks
+        queue.shiftSamplePositions(-numSamples);
+        nextFreeSampleCarry = nextFreeSample - numSamples > 0 ? nextFreeSample - numSamples : 0;
+        return maxDelay;
+    }
+
+    void reset() { nextFreeSampleCarry = 0; }
+
+private:
+    static bool isLimited(const DeliveryPolicy& policy, int numSamples)
+    {
+        return policy.maxBlockSize <= 0 || numSamples <= policy.maxBlockSize;
+    }
+
+    static int GetSpacing(const DeliveryPolicy& policy)
+    {
+        if(policy.mode != DeliveryMode::spreadOverSamples) return 0;
+        auto spacing = policy.spreadSamples / (MAX_EVENTS_PER_CHANGE - 1);
+        return spacing < 1 ? 1 : spacing;
+    }
+
+    DeliveryPolicy policy;
+    int nextFreeSampleCarry = 0; // first sample in the next block a spread event may use
+};
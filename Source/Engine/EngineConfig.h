@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    EngineConfig.h
+    Created: 17 Oct 2026 11:20:33am
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include "EngineDefines.h"
+#include "ChordCompiler.h"
+#include "ZoneClassifier.h"
+
+//==============================================================================
+// How a note that was playing is stopped.
+// noteOffAndZeroVelocity sends both a note on with velocity 0 and a note off,
+// which is what the plugin always did and what works with every synth.
+//==============================================================================
+enum class NoteOffStyle { noteOffAndZeroVelocity = 0, noteOff, zeroVelocityNoteOn };
+
+//==============================================================================
+// The parameter values the engine config is compiled from.
+//==============================================================================
+struct EngineSettings
+{
+    int midiCC;
+    int numberOfZones;
+    int splitValues[MAX_SPLITS];
+    int channelIn;                 // 0 = all
+    int channelOut;                // 0 = same as the channel in
+    int hysteresis;                // in cc steps
+    int minimumDwellMs;            // time a new zone must be selected before it is played
+    bool legato;                   // only send the notes that differ between two chords
+    int noteOffStyle;              // NoteOffStyle
+    ChordSettings chords;
+};
+
+//==============================================================================
+// Everything the audio thread needs to turn ribbon messages into notes.
+// A config is compiled on the message thread and never changed after it has
+// been published, so the audio thread always sees a consistent set of
+// splits and chords, also while a preset is loading or a progression is
+// transposed.
+//==============================================================================
+struct EngineConfig
+{
+    int midiCC;
+    int numberOfZones;
+    int splitValues[MAX_SPLITS];
+    int channelIn;
+    int channelOut;
+    int minimumDwellMs;
+    bool legato;
+    NoteOffStyle noteOffStyle;
+    ZoneClassifier zones;
+    ChordTable chords;
+
+    // the preset the config belongs to, not set by Compile. When the serial changes the engine
+    // stops the notes of the previous preset at the start of the block. A preset that is loaded
+    // in the background also brings its progression, velocity and note offset, for the blocks
+    // before its parameters are set.
+    struct Preset
+    {
+        std::uint32_t serial = 0;
+        int activeProgression = 0;
+        std::uint8_t velocity = 0;
+        int noteOffset = 0; // transpose and octave shift, in semitones
+    };
+    Preset preset;
+
+    static void Compile(const EngineSettings& settings, EngineConfig& config)
+    {
+        config.midiCC = settings.midiCC;
+        config.numberOfZones = settings.numberOfZones < 1 ? 1 : settings.numberOfZones > MAX_ZONES ? MAX_ZONES : settings.numberOfZones;
+        for(int i=0;i<MAX_SPLITS;i++)
+        {
+            config.splitValues[i] = settings.splitValues[i];
+        }
+        config.channelIn = settings.channelIn;
+        config.channelOut = settings.channelOut;
+        config.minimumDwellMs = settings.minimumDwellMs < 0 ? 0 : settings.minimumDwellMs;
+        config.legato = settings.legato;
+        config.noteOffStyle = settings.noteOffStyle == (int) NoteOffStyle::noteOff ? NoteOffStyle::noteOff
+                            : settings.noteOffStyle == (int) NoteOffStyle::zeroVelocityNoteOn ? NoteOffStyle::zeroVelocityNoteOn
+                            : NoteOffStyle::noteOffAndZeroVelocity;
+        config.zones.Build(config.splitValues, config.numberOfZones, settings.hysteresis);
+        ChordCompiler::Compile(settings.chords, config.chords);
+    }
+};
@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    EngineDefines.h
+    Created: 17 Oct 2026 10:02:18am
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// sizes shared by the plugin and the engine. These do not depend on juce.
+const int NONOTE = -128;
+
+#define MAX_PROGRESSIONS 6
+#define MAX_PROGRESSIONSKNOBS MAX_PROGRESSIONS+2
+#define MAX_NOTES 12
+#define MAX_ZONES 8
+#define MAX_SPLITS MAX_ZONES+1
+#define DEFAULT_NUMBEROFZONES 6
+#define MAX_TRANSPOSE 12
+#define MAX_OCTAVESHIFT 3
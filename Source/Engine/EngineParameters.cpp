@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    EngineParameters.cpp
+    Created: 17 Oct 2026 9:40:12pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "EngineParameters.h"
+#include <cmath>
+
+namespace
+{
+// parses "<prefix><a>_<b>_<c>" style ids. Returns the number of indexes found.
+int ParseIndexes(const std::string& id, const char* prefix, int indexes[3])
+{
+    std::string start(prefix);
+    if(id.compare(0, start.size(), start) != 0) return 0;
+
+    int count = 0;
+    auto position = start.size();
+    while(count < 3 && position < id.size())
+    {
+        if(id[position] < '0' || id[position] > '9') return 0;
+        int value = 0;
+        while(position < id.size() && id[position] >= '0' && id[position] <= '9')
+        {
+            value = value * 10 + (id[position++] - '0');
+        }
+        indexes[count++] = value;
+        if(position < id.size())
+        {
+            if(id[position] != '_') return 0;
+            position++;
+        }
+    }
+    return position == id.size() ? count : 0;
+}
+
+bool SetLearnedControl(LearnedControl& control, const std::string& field, int value)
+{
+    if(field == MIDIINMESSAGETYPE_ID) control.messageType = value;
+    else if(field == MIDIINCHANNEL_ID) control.channel = value;
+    else if(field == MIDIINNUMBER_ID) control.number = value;
+    else if(field == MIDIINMINVALUE_ID) control.minValue = value;
+    else if(field == MIDIINMAXVALUE_ID) control.maxValue = value;
+    else return false;
+    return true;
+}
+}
+
+//==============================================================================
+bool LearnedControl::Complies(const std::uint8_t* data, int size, int& value) const
+{
+    if(size < 3) return false;
+    auto status = data[0] & 0xf0;
+    auto type = status == 0xb0 ? 1 : (status == 0x90 && data[2] > 0) ? 2 : 0;
+    if(type == 0 || type != messageType) return false;
+    if(data[1] != number) return false;
+    if(channel != 0 && (data[0] & 0x0f) + 1 != channel) return false;
+    value = data[2];
+    return value >= minValue && value < maxValue;
+}
+
+//==============================================================================
+EngineParameters EngineParameters::CreateDefault()
+{
+    EngineParameters parameters {};
+    auto& settings = parameters.settings;
+    settings.midiCC = DEFAULT_MIDICC;
+    settings.numberOfZones = DEFAULT_NUMBEROFZONES;
+    settings.channelIn = 0;
+    settings.channelOut = 0;
+    settings.hysteresis = 0;
+    settings.minimumDwellMs = 0;
+    settings.legato = false;
+    settings.noteOffStyle = 0;
+
+    int stepSize = 127/DEFAULT_NUMBEROFZONES;
+    for(int i=0;i<MAX_SPLITS;i++)
+    {
+        settings.splitValues[i] = i < DEFAULT_NUMBEROFZONES ? 1 + i * stepSize : 128;
+    }
+    settings.splitValues[0] = 0;
+
+    settings.chords.chordNotes = ChordBuilds::CreateDefault();
+    settings.chords.octave = DEFAULT_OCTAVE;
+    settings.chords.pitchMode = 0;
+    for(int prog=0;prog<MAX_PROGRESSIONS;prog++)
+    {
+        for(int zone=0;zone<MAX_ZONES;zone++)
+        {
+            settings.chords.keys[prog][zone] = defaultNoteOrder[zone];
+        }
+    }
+
+    parameters.activeProgression = 0;
+    parameters.velocity = DEFAULT_VELOCITY;
+    parameters.velocityControl = {0, 0, 11, 0, 127};
+    parameters.transpose = 0;
+    parameters.octaveShift = 0;
+    parameters.transposeControl = {0, 0, 14, 0, 127};
+    parameters.octaveShiftControl = {0, 0, 15, 0, 127};
+    for(int prog=0;prog<MAX_PROGRESSIONSKNOBS;prog++)
+    {
+        parameters.progressionControls[prog] = {2, 0, 24 + prog, 1, 127};
+    }
+    return parameters;
+}
+
+bool EngineParameters::SetParameter(const std::string& id, float value)
+{
+    auto intValue = (int) std::lround(value);
+    int indexes[3];
+
+    if(id == MIDICC_ID) settings.midiCC = intValue;
+    else if(id == NUMBEROFZONES_ID) settings.numberOfZones = intValue;
+    else if(id == VELOCITY_ID) velocity = value;
+    else if(id == OCTAVES_ID) settings.chords.octave = intValue;
+    else if(id == HYSTERESIS_ID) settings.hysteresis = intValue;
+    else if(id == MINIMUMDWELL_ID) settings.minimumDwellMs = intValue;
+    else if(id == LEGATO_ID) settings.legato = value > 0.5f;
+    else if(id == NOTEOFFSTYLE_ID) settings.noteOffStyle = intValue;
+    else if(id == CHANNELIN_ID) settings.channelIn = intValue;
+    else if(id == CHANNELOUT_ID) settings.channelOut = intValue;
+    else if(id == PITCHMODES_ID) settings.chords.pitchMode = intValue;
+    else if(id == ACTIVEPROGRESSION_ID) activeProgression = intValue;
+    else if(id == TRANSPOSE_ID) transpose = intValue;
+    else if(id == OCTAVESHIFT_ID) octaveShift = intValue;
+    else if(ParseIndexes(id, SPLITS_ID, indexes) == 1)
+    {
+        if(indexes[0] >= MAX_SPLITS) return false;
+        settings.splitValues[indexes[0]] = indexes[0] == 0 ? 0 : intValue;
+    }
+    else if(ParseIndexes(id, KEYS_ID, indexes) == 2)
+    {
+        if(indexes[0] >= MAX_PROGRESSIONS || indexes[1] >= MAX_ZONES) return false;
+        settings.chords.keys[indexes[0]][indexes[1]] = intValue;
+    }
+    else if(ParseIndexes(id, CHORDBUILDS_ID, indexes) == 3)
+    {
+        // chord builds of older versions, stored as parameters
+        if(indexes[0] >= MAX_PROGRESSIONS || indexes[1] >= MAX_ZONES || indexes[2] >= MAX_NOTES) return false;
+        settings.chords.chordNotes.Set(indexes[0], indexes[1], indexes[2], intValue);
+    }
+    else if(id.size() > std::string(PROGRESSION).size() && id.find(PROGRESSION) != std::string::npos)
+    {
+        // midiIn<field>Progression<n>
+        auto position = id.find(PROGRESSION);
+        auto prog = std::atoi(id.c_str() + position + std::string(PROGRESSION).size());
+        if(prog < 0 || prog >= MAX_PROGRESSIONSKNOBS) return false;
+        return SetLearnedControl(progressionControls[prog], id.substr(0, position), intValue);
+    }
+    else if(id.size() > std::string(VELOCITY_ID).size()
+            && id.compare(id.size() - std::string(VELOCITY_ID).size(), std::string::npos, VELOCITY_ID) == 0)
+    {
+        // midiIn<field>velocity
+        return SetLearnedControl(velocityControl, id.substr(0, id.size() - std::string(VELOCITY_ID).size()), intValue);
+    }
+    else if(id.size() > std::string(TRANSPOSE_ID).size()
+            && id.compare(id.size() - std::string(TRANSPOSE_ID).size(), std::string::npos, TRANSPOSE_ID) == 0)
+    {
+        // midiIn<field>transpose
+        return SetLearnedControl(transposeControl, id.substr(0, id.size() - std::string(TRANSPOSE_ID).size()), intValue);
+    }
+    else if(id.size() > std::string(OCTAVESHIFT_ID).size()
+            && id.compare(id.size() - std::string(OCTAVESHIFT_ID).size(), std::string::npos, OCTAVESHIFT_ID) == 0)
+    {
+        // midiIn<field>octaveshift
+        return SetLearnedControl(octaveShiftControl, id.substr(0, id.size() - std::string(OCTAVESHIFT_ID).size()), intValue);
+    }
+    else return false;
+    return true;
+}
+
+// same as SetControlByMidi in the processor
+bool EngineParameters::ApplyLearnedControl(const std::uint8_t* data, int size)
+{
+    int value = 0;
+    //controller value that sets the midi velocity?
+    if(velocityControl.Complies(data, size, value))
+    {
+        velocity = (float) ((velocityControl.minValue + (velocityControl.maxValue - velocityControl.minValue) * value / 127.0) / 127.0);
+        return true;
+    }
+    if(transposeControl.Complies(data, size, value))
+    {
+        transpose = GetLearnedOffset(transposeControl.minValue, transposeControl.maxValue, value, MAX_TRANSPOSE);
+        return true;
+    }
+    if(octaveShiftControl.Complies(data, size, value))
+    {
+        octaveShift = GetLearnedOffset(octaveShiftControl.minValue, octaveShiftControl.maxValue, value, MAX_OCTAVESHIFT);
+        return true;
+    }
+
+    int ap = activeProgression;
+    for(int i=0; i < MAX_PROGRESSIONSKNOBS;i++)
+    {
+        if(progressionControls[i].Complies(data, size, value))
+        {
+            if(i < MAX_PROGRESSIONS)
+            {
+                ap = i;
+            }
+            else if(i == MAX_PROGRESSIONS)
+            {
+                ap--;
+                ap = ap < 0 ? MAX_PROGRESSIONS-1 : ap;
+            }
+            else
+            {
+                ap++;
+                ap = ap < MAX_PROGRESSIONS ? ap : 0;
+            }
+            activeProgression = ap;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::uint8_t EngineParameters::GetMidiVelocity() const
+{
+    auto value = (int) std::lround(velocity * 127.0f);
+    return (std::uint8_t) (value < 0 ? 0 : value > 127 ? 127 : value);
+}
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    EngineParameters.h
+    Created: 17 Oct 2026 9:40:12pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include "EngineDefines.h"
+#include "EngineConfig.h"
+#include "ParameterIDs.h"
+
+// defaults of the parameters, shared with the parameter layout of the plugin
+const int defaultNoteOrder[MAX_NOTES] = {1,3,5,6,8,10,12,1,3,5,6,8};
+const int DEFAULT_MIDICC = 22;
+const int DEFAULT_OCTAVE = 2;
+const float DEFAULT_VELOCITY = 90.0f/127.0f;
+
+//==============================================================================
+// A midi message that is learned to control the plugin, e.g. a note that
+// selects a progression. messageType 0 = none, 1 = cc, 2 = note on.
+// Channel 0 is any channel. The value must be in [minValue, maxValue).
+//==============================================================================
+struct LearnedControl
+{
+    int messageType;
+    int channel;
+    int number;
+    int minValue;
+    int maxValue;
+
+    // returns true and the cc value or velocity when the message is this control
+    bool Complies(const std::uint8_t* data, int size, int& value) const;
+};
+
+// the value of a control, scaled between minValue and maxValue like the velocity, as a
+// number in -range..range. Used for the transpose and octave shift controls.
+inline int GetLearnedOffset(int minValue, int maxValue, int value, int range)
+{
+    auto normalised = (minValue + (maxValue - minValue) * value / 127.0) / 127.0;
+    auto offset = (int) std::lround(-range + 2 * range * normalised);
+    return offset < -range ? -range : offset > range ? range : offset;
+}
+
+//==============================================================================
+// All plugin parameters the ribbon engine depends on, without JUCE. Used by the
+// tools to work with presets and state blobs of the plugin.
+//==============================================================================
+struct EngineParameters
+{
+    EngineSettings settings;
+    int activeProgression;
+    float velocity;                                   // 0..1
+    LearnedControl velocityControl;
+    int transpose;                                    // semitones, -MAX_TRANSPOSE..MAX_TRANSPOSE
+    int octaveShift;                                  // octaves, -MAX_OCTAVESHIFT..MAX_OCTAVESHIFT
+    LearnedControl transposeControl;
+    LearnedControl octaveShiftControl;
+    LearnedControl progressionControls[MAX_PROGRESSIONSKNOBS];
+
+    // the values a new instance of the plugin starts with
+    static EngineParameters CreateDefault();
+
+    // sets the parameter with the given id. Returns false for ids the engine does not use.
+    bool SetParameter(const std::string& id, float value);
+
+    // handles a learned control the way the processor does. Returns true when the message was a control.
+    bool ApplyLearnedControl(const std::uint8_t* data, int size);
+
+    std::uint8_t GetMidiVelocity() const;
+    // transpose and octave shift in semitones, see RibbonEngine::SetNoteOffset
+    int GetNoteOffset() const { return transpose + 12 * octaveShift; }
+};
@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    MidiEventQueue.h
+    Created: 17 Oct 2026 9:12:40am
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//==============================================================================
+// Plain midi event that can be copied around without any allocation.
+// Only short messages (note on/off, cc, pitch bend, clock, etc.) are stored.
+//==============================================================================
+struct MidiEvent
+{
+    std::uint8_t data[3];
+    std::uint8_t size;
+    int samplePosition;
+
+    static MidiEvent create(const std::uint8_t* bytes, int numBytes, int samplePosition)
+    {
+        MidiEvent event {{0, 0, 0}, 0, samplePosition};
+        event.size = (std::uint8_t) (numBytes < 3 ? (numBytes > 0 ? numBytes : 0) : 3);
+        for(int i = 0; i < event.size; i++)
+        {
+            event.data[i] = bytes[i];
+        }
+        return event;
+    }
+    static MidiEvent noteOn(int channel, int note, std::uint8_t velocity, int samplePosition)
+    {
+        return {{(std::uint8_t) (0x90 | ((channel - 1) & 0x0f)), (std::uint8_t) (note & 0x7f), (std::uint8_t) (velocity & 0x7f)}, 3, samplePosition};
+    }
+    static MidiEvent noteOff(int channel, int note, int samplePosition)
+    {
+        return {{(std::uint8_t) (0x80 | ((channel - 1) & 0x0f)), (std::uint8_t) (note & 0x7f), 0}, 3, samplePosition};
+    }
+    static MidiEvent allNotesOff(int channel, int samplePosition)
+    {
+        return {{(std::uint8_t) (0xb0 | ((channel - 1) & 0x0f)), 123, 0}, 3, samplePosition};
+    }
+};
+
+//==============================================================================
+// What to do when the queue is full.
+// dropNewest keeps the events that are already queued (so earlier note offs
+// are never lost) and rejects the incoming event.
+// dropOldest discards the event at the front to make room for the new one.
+//==============================================================================
+enum class QueueOverflowPolicy { dropNewest, dropOldest };
+
+//==============================================================================
+// Fixed capacity fifo for midi events. The storage is allocated in prepare(),
+// which must be called from prepareToPlay. After that, push and pop never
+// allocate, so the queue can be used on the audio thread.
+// The queue itself is not thread safe: it is owned by the audio thread. Only
+// the overflow counter may be read from another thread.
+//==============================================================================
+class MidiEventQueue
+{
+public:
+    void prepare(int capacity)
+    {
+        if(capacity < 1) capacity = 1;
+        if((int) storage.size() != capacity)
+        {
+            storage.assign((std::size_t) capacity, MidiEvent{});
+        }
+        clear();
+    }
+
+    void setOverflowPolicy(QueueOverflowPolicy policy) { overflowPolicy = policy; }
+    QueueOverflowPolicy getOverflowPolicy() const { return overflowPolicy; }
+
+    // returns false if the event was dropped because the queue was full.
+    bool push(const MidiEvent& event)
+    {
+        if(storage.empty())
+        {
+            overflowCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if(numEvents == capacity())
+        {
+            overflowCount.fetch_add(1, std::memory_order_relaxed);
+            if(overflowPolicy == QueueOverflowPolicy::dropNewest)
+            {
+                return false;
+            }
+            head = next(head);
+            numEvents--;
+        }
+        storage[(std::size_t) tail] = event;
+        tail = next(tail);
+        numEvents++;
+        return true;
+    }
+
+    bool pop(MidiEvent& event)
+    {
+        if(numEvents == 0) return false;
+        event = storage[(std::size_t) head];
+        head = next(head);
+        numEvents--;
+        return true;
+    }
+
+    const MidiEvent& front() const { return storage[(std::size_t) head]; }
+
+    // moves all queued events in time, e.g. to carry events that could not be played over to the next block.
+    // A negative position means the event is late by that many samples.
+    void shiftSamplePositions(int offset)
+    {
+        for(int i = 0, index = head; i < numEvents; i++, index = next(index))
+        {
+            storage[(std::size_t) index].samplePosition += offset;
+        }
+    }
+
+    // removes the last queued note on of the note. With onlyLate, only a note on that is late (carried over
+    // from a previous block, see shiftSamplePositions) is removed. Returns false when there is none, or
+    // when a later event of the note is queued.
+    bool removeNoteOn(int channel, int note, bool onlyLate)
+    {
+        for(int i = numEvents - 1; i >= 0; i--)
+        {
+            const auto index = (head + i) % capacity();
+            const auto& event = storage[(std::size_t) index];
+            const auto status = event.data[0] & 0xf0;
+            if((status != 0x80 && status != 0x90) || (event.data[0] & 0x0f) != ((channel - 1) & 0x0f) || event.data[1] != note)
+            {
+                continue;
+            }
+            if(status == 0x80 || event.data[2] == 0 || (onlyLate && event.samplePosition >= 0))
+            {
+                return false;
+            }
+            // close the gap
+            for(int j = i, at = index; j < numEvents - 1; j++)
+            {
+                const auto from = next(at);
+                storage[(std::size_t) at] = storage[(std::size_t) from];
+                at = from;
+            }
+            tail = tail == 0 ? capacity() - 1 : tail - 1;
+            numEvents--;
+            return true;
+        }
+        return false;
+    }
+
+    void clear()
+    {
+        head = 0;
+        tail = 0;
+        numEvents = 0;
+    }
+
+    int size() const { return numEvents; }
+    bool isEmpty() const { return numEvents == 0; }
+    int capacity() const { return (int) storage.size(); }
+
+    // number of events dropped since the last reset. Can be read from any thread.
+    std::uint32_t getOverflowCount() const { return overflowCount.load(std::memory_order_relaxed); }
+    void resetOverflowCount() { overflowCount.store(0, std::memory_order_relaxed); }
+
+private:
+    int next(int index) const { return index + 1 == capacity() ? 0 : index + 1; }
+
+    std::vector<MidiEvent> storage;
+    int head = 0;
+    int tail = 0;
+    int numEvents = 0;
+    QueueOverflowPolicy overflowPolicy = QueueOverflowPolicy::dropNewest;
+    std::atomic<std::uint32_t> overflowCount {0};
+};
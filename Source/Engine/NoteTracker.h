@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    NoteTracker.h
+    Created: 17 Oct 2026 3:05:52pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+
+//==============================================================================
+// Keeps track of the notes that are sounding, as one bit per note for each of
+// the 16 midi channels. Updates are O(1) and nothing is allocated, so it can
+// be used on the audio thread. Channels are 1..16, like in juce::MidiMessage.
+//==============================================================================
+class NoteTracker
+{
+public:
+    void NoteOn(int channel, int note)
+    {
+        auto index = Index(channel);
+        bits[index][(note >> 6) & 1] |= Bit(note);
+        soundingChannels |= (std::uint16_t) (1u << index);
+    }
+
+    void NoteOff(int channel, int note)
+    {
+        auto index = Index(channel);
+        bits[index][(note >> 6) & 1] &= ~Bit(note);
+        if((bits[index][0] | bits[index][1]) == 0)
+        {
+            soundingChannels &= (std::uint16_t) ~(1u << index);
+        }
+    }
+
+    bool IsSounding(int channel, int note) const
+    {
+        return (bits[Index(channel)][(note >> 6) & 1] & Bit(note)) != 0;
+    }
+
+    bool IsChannelSounding(int channel) const { return (soundingChannels & (1u << Index(channel))) != 0; }
+    bool IsAnySounding() const { return soundingChannels != 0; }
+
+    // calls function(channel, note) for every sounding note, ordered by channel and note.
+    // The tracker itself is not changed, so the function may call NoteOff.
+    template <typename Function>
+    void ForEachSounding(Function&& function) const
+    {
+        for(int index=0;index<16;index++)
+        {
+            if((soundingChannels & (1u << index)) == 0) continue;
+            for(int word=0;word<2;word++)
+            {
+                auto noteBits = bits[index][word];
+                for(int bit=0;noteBits!=0;bit++, noteBits >>= 1)
+                {
+                    if(noteBits & 1)
+                    {
+                        function(index + 1, word * 64 + bit);
+                    }
+                }
+            }
+        }
+    }
+
+    void Clear()
+    {
+        for(auto& channelBits : bits)
+        {
+            channelBits[0] = 0;
+            channelBits[1] = 0;
+        }
+        soundingChannels = 0;
+    }
+
+private:
+    static int Index(int channel) { return (channel - 1) & 0x0f; }
+    static std::uint64_t Bit(int note) { return std::uint64_t(1) << (note & 0x3f); }
+
+    std::uint64_t bits[16][2] = {};
+    std::uint16_t soundingChannels = 0; // one bit per channel that has sounding notes
+};
@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    ParameterIDs.h
+    Created: 17 Oct 2026 9:40:12pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "EngineDefines.h"
+
+#define MIDICC_ID "midicc"
+#define MIDICC_NAME "midi cc"
+#define NUMBEROFZONES_ID "numberofzones"
+#define NUMBEROFZONES_NAME "Number of zones"
+#define VELOCITY_ID "velocity"
+#define VELOCITY_NAME "Velocity"
+#define OCTAVES_ID "octaves"
+#define OCTAVES_NAME "Octaves"
+#define HYSTERESIS_ID "hysteresis"
+#define HYSTERESIS_NAME "Zone hysteresis"
+#define MINIMUMDWELL_ID "minimumdwell"
+#define MINIMUMDWELL_NAME "Minimum zone dwell (ms)"
+#define LEGATO_ID "legato"
+#define LEGATO_NAME "Legato chord changes"
+#define NOTEOFFSTYLE_ID "noteoffstyle"
+#define NOTEOFFSTYLE_NAME "Note off style"
+#define TRANSPOSE_ID "transpose"
+#define TRANSPOSE_NAME "Transpose"
+#define OCTAVESHIFT_ID "octaveshift"
+#define OCTAVESHIFT_NAME "Octave shift"
+
+#define TOGGLEMIDI_NAME "Show midi controls"
+#define TOGGLEMIDILEARN_NAME "Midi learn"
+
+#define CHANNELIN_ID "channelin"
+#define CHANNELIN_NAME "Channel in"
+#define CHANNELOUT_ID "channelout"
+#define CHANNELOUT_NAME "Channel out"
+#define PITCHMODES_ID "pitchmodes"
+#define PITCHMODES_NAME "Pitch modes"
+#define ACTIVEPROGRESSION_ID "activeprogression"
+#define ACTIVEPROGRESSION_NAME "Active progression"
+#define KEYS_ID "keys"
+#define KEYS_NAME "Keys"
+#define CHORDS_ID "chords"
+#define CHORDS_NAME "Chords"
+#define SPLITS_ID "splits"
+#define SPLITS_NAME "Splits"
+
+#define MIDIINMESSAGETYPE_ID "midiInMessageType"
+#define MIDIINMESSAGETYPE_NAME "midiInMessageType"
+#define MIDIINCHANNEL_ID "midiInChannel"
+#define MIDIINCHANNEL_NAME "midiInChannel"
+#define MIDIINNUMBER_ID "midiInNumber"
+#define MIDIINNUMBER_NAME "midiInNumber"
+#define MIDIINMINVALUE_ID "midiInMinValue"
+#define MIDIINMINVALUE_NAME "midiInMinValue"
+#define MIDIINMAXVALUE_ID "midiInMaxValue"
+#define MIDIINMAXVALUE_NAME "midiInMaxValue"
+
+#define PROGRESSION "Progression"
+
+// parameters of older versions. They are removed from old sessions and presets when loaded.
+// notestoplay<prog>_<zone>_<note>: the notes of the chords, now compiled from keys, chordbuilds, octaves and pitchmodes
+// chordbuilds<prog>_<zone>_<note>: one parameter per interval, now the CHORDBUILDS_ID property
+#define NOTESTOPLAY_ID "notestoplay"
+
+// property of the plugin state that holds the packed chord builds (see ChordBuilds.h)
+#define CHORDBUILDS_ID "chordbuilds"
+
+// element of the plugin state that holds the delivery policy
+#define DELIVERY_TAG "DELIVERY"
+
+//==============================================================================
+// The ids of the parameters with an index, e.g. "keys2_5", built at compile
+// time, so creating and binding the parameters does not build any strings.
+//
+//   GetParameterID(ParameterKind::keys, progression, zone)
+//   GetParameterID(ParameterKind::splits, split)
+//   GetParameterID(ParameterKind::midiInNumberProgression, knob)
+//==============================================================================
+enum class ParameterKind
+{
+    keys = 0,                       // KEYS_ID<prog>_<zone>
+    chords,                         // CHORDS_ID<prog>_<zone>
+    splits,                         // SPLITS_ID<split>
+    midiInMessageTypeProgression,   // MIDIINMESSAGETYPE_ID PROGRESSION<knob>
+    midiInChannelProgression,
+    midiInNumberProgression,
+    midiInMinValueProgression,
+    midiInMaxValueProgression,
+    numKinds
+};
+
+class ParameterIDTable
+{
+public:
+    static constexpr int MaxFirstIndex = (MAX_SPLITS) > (MAX_PROGRESSIONSKNOBS) ? (MAX_SPLITS) : (MAX_PROGRESSIONSKNOBS);
+    static constexpr int MaxLength = 32;
+
+    constexpr ParameterIDTable()
+    {
+        for(int first=0;first<MaxFirstIndex;first++)
+        {
+            for(int second=0;second<MAX_ZONES;second++)
+            {
+                Build(ParameterKind::keys, KEYS_ID, first, second);
+                Build(ParameterKind::chords, CHORDS_ID, first, second);
+            }
+            Build(ParameterKind::splits, SPLITS_ID, first, -1);
+            Build(ParameterKind::midiInMessageTypeProgression, MIDIINMESSAGETYPE_ID PROGRESSION, first, -1);
+            Build(ParameterKind::midiInChannelProgression, MIDIINCHANNEL_ID PROGRESSION, first, -1);
+            Build(ParameterKind::midiInNumberProgression, MIDIINNUMBER_ID PROGRESSION, first, -1);
+            Build(ParameterKind::midiInMinValueProgression, MIDIINMINVALUE_ID PROGRESSION, first, -1);
+            Build(ParameterKind::midiInMaxValueProgression, MIDIINMAXVALUE_ID PROGRESSION, first, -1);
+        }
+    }
+
+    constexpr const char* Get(ParameterKind kind, int first, int second = 0) const
+    {
+        return ids[(int) kind][first][second];
+    }
+
+private:
+    // <prefix><first> or <prefix><first>_<second>. Kinds with one index are stored at second = 0.
+    constexpr void Build(ParameterKind kind, const char* prefix, int first, int second)
+    {
+        char* id = ids[(int) kind][first][second < 0 ? 0 : second];
+        int length = 0;
+        while(prefix[length] != 0)
+        {
+            id[length] = prefix[length];
+            length++;
+        }
+        AppendNumber(id, length, first);
+        if(second >= 0)
+        {
+            id[length++] = '_';
+            AppendNumber(id, length, second);
+        }
+        id[length] = 0;
+    }
+
+    static constexpr void AppendNumber(char* id, int& length, int value)
+    {
+        if(value >= 10)
+        {
+            id[length++] = (char) ('0' + value / 10);
+        }
+        id[length++] = (char) ('0' + value % 10);
+    }
+
+    char ids[(int) ParameterKind::numKinds][MaxFirstIndex][MAX_ZONES][MaxLength] {};
+};
+
+inline constexpr ParameterIDTable parameterIDTable;
+
+constexpr const char* GetParameterID(ParameterKind kind, int first, int second = 0)
+{
+    return parameterIDTable.Get(kind, first, second);
+}
@@ -0,0 +1,39 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    Created: 18 Oct 2026 12:41:09am
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "EngineConfig.h"
+#include "EngineParameters.h"
+
+//==============================================================================
+// Presets that are compiled ahead of time, so a program change can switch to
+// one of them on the audio thread without reading a file. Program number n
+// selects presets[n], the presets are in the order of their names.
+// A bank is not changed after it has been published.
+//==============================================================================
+struct PresetBank
+{
+    static const int MaxPresets = 128; // one for every program number
+
+    int numPresets = 0;
+    EngineConfig presets[MaxPresets];
+};
+
+//==============================================================================
+// Settings of the bank. They belong to the session, not to a preset, so
+// selecting a preset from the bank does not change them. next and previous
+// are learned controls that step through the bank, e.g. footswitches.
+//==============================================================================
+struct PresetBankSettings
+{
+    bool enabled = false;
+    LearnedControl next {0, 0, 0, 1, 128};
+    LearnedControl previous {0, 0, 0, 1, 128};
+};
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    PresetBankFile.cpp
+    Created: 18 Oct 2026 10:37:52am
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "PresetBankFile.h"
+#include <cstring>
+
+namespace
+{
+const std::size_t HeaderSize = 12;
+const std::size_t IndexEntrySize = 8;
+
+std::uint32_t ReadValue(const std::uint8_t* position, int numBytes)
+{
+    std::uint32_t value = 0;
+    for(int i=0;i<numBytes;i++)
+    {
+        value |= (std::uint32_t) position[i] << (8 * i);
+    }
+    return value;
+}
+
+void WriteValue(std::uint8_t* position, std::uint32_t value, int numBytes)
+{
+    for(int i=0;i<numBytes;i++)
+    {
+        position[i] = (std::uint8_t) (value >> (8 * i));
+    }
+}
+}
+
+//==============================================================================
+bool PresetBankFile::IsPresetBank(const void* data, std::size_t size)
+{
+    return data != nullptr && size >= HeaderSize && ReadValue(static_cast<const std::uint8_t*>(data), 4) == Magic;
+}
+
+bool PresetBankFile::Open(const void* data, std::size_t size)
+{
+    if(! IsPresetBank(data, size))
+    {
+        return false;
+    }
+    auto* bytes = static_cast<const std::uint8_t*>(data);
+    const auto version = ReadValue(bytes + 4, 2);
+    const auto count = ReadValue(bytes + 8, 4);
+    if(version < 1 || version > FormatVersion || count > (size - HeaderSize) / IndexEntrySize)
+    {
+        return false;
+    }
+    // every record is checked once here, so reading a preset does not have to
+    for(std::uint32_t i=0;i<count;i++)
+    {
+        const auto* entry = bytes + HeaderSize + i * IndexEntrySize;
+        const std::size_t offset = ReadValue(entry, 4);
+        const std::size_t recordSize = ReadValue(entry + 4, 4);
+        if(offset > size || recordSize > size - offset || recordSize < 2 || ReadValue(bytes + offset, 2) > recordSize - 2)
+        {
+            return false;
+        }
+    }
+    bankData = bytes;
+    bankSize = size;
+    numPresets = (int) count;
+    return true;
+}
+
+bool PresetBankFile::GetRecord(int index, const std::uint8_t*& record, std::size_t& recordSize) const
+{
+    if(index < 0 || index >= numPresets)
+    {
+        return false;
+    }
+    const auto* entry = bankData + HeaderSize + (std::size_t) index * IndexEntrySize;
+    record = bankData + ReadValue(entry, 4);
+    recordSize = ReadValue(entry + 4, 4);
+    return true;
+}
+
+std::string PresetBankFile::GetName(int index) const
+{
+    const std::uint8_t* record;
+    std::size_t recordSize;
+    if(! GetRecord(index, record, recordSize))
+    {
+        return {};
+    }
+    return std::string(reinterpret_cast<const char*>(record + 2), ReadValue(record, 2));
+}
+
+bool PresetBankFile::ReadPreset(int index, BinaryState& state) const
+{
+    const std::uint8_t* record;
+    std::size_t recordSize;
+    if(! GetRecord(index, record, recordSize))
+    {
+        return false;
+    }
+    const std::size_t nameSize = 2 + ReadValue(record, 2);
+    return state.Read(record + nameSize, recordSize - nameSize);
+}
+
+std::vector<std::uint8_t> PresetBankFile::Write(const std::vector<Preset>& presets)
+{
+    auto size = HeaderSize + presets.size() * IndexEntrySize;
+    for(const auto& preset : presets)
+    {
+        size += 2 + preset.name.size() + preset.state.GetSize();
+    }
+    std::vector<std::uint8_t> bank(size);
+    WriteValue(bank.data(), Magic, 4);
+    WriteValue(bank.data() + 4, FormatVersion, 2);
+    WriteValue(bank.data() + 8, (std::uint32_t) presets.size(), 4);
+
+    auto offset = HeaderSize + presets.size() * IndexEntrySize;
+    for(std::size_t i=0;i<presets.size();i++)
+    {
+        const auto& preset = presets[i];
+        const auto recordSize = 2 + preset.name.size() + preset.state.GetSize();
+        WriteValue(bank.data() + HeaderSize + i * IndexEntrySize, (std::uint32_t) offset, 4);
+        WriteValue(bank.data() + HeaderSize + i * IndexEntrySize + 4, (std::uint32_t) recordSize, 4);
+        WriteValue(bank.data() + offset, (std::uint32_t) preset.name.size(), 2);
+        if(! preset.name.empty()) std::memcpy(bank.data() + offset + 2, preset.name.data(), preset.name.size());
+        preset.state.Write(bank.data() + offset + 2 + preset.name.size());
+        offset += recordSize;
+    }
+    return bank;
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    PresetBankFile.h
+    Created: 18 Oct 2026 10:37:52am
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "BinaryState.h"
+
+//==============================================================================
+// Many presets in one file, read in place (e.g. from a memory mapped file).
+// Little endian:
+//
+//   uint32 Magic ("RTBK"), uint16 FormatVersion, uint16 reserved, uint32 number of presets
+//   the index, per preset: uint32 offset of its record, uint32 size of its record
+//   the records, per preset: uint16 size, name (utf-8), the preset as a BinaryState
+//
+// Finding a preset is a lookup in the index, loading it is reading its record.
+// The delivery policy and the bank settings of the records are not used.
+//==============================================================================
+class PresetBankFile
+{
+public:
+    static const std::uint32_t Magic = 0x4b425452; // "RTBK"
+    static const int FormatVersion = 1;
+
+    struct Preset
+    {
+        std::string name;
+        BinaryState state;
+    };
+
+    static bool IsPresetBank(const void* data, std::size_t size);
+
+    // the data is not copied, it must stay valid while the bank is used. Returns false when it is
+    // not a bank of a known version, or when the index points outside of the data.
+    bool Open(const void* data, std::size_t size);
+    int GetNumPresets() const { return numPresets; }
+    std::string GetName(int index) const;
+    // returns false when the record is damaged
+    bool ReadPreset(int index, BinaryState& state) const;
+
+    static std::vector<std::uint8_t> Write(const std::vector<Preset>& presets);
+
+private:
+    bool GetRecord(int index, const std::uint8_t*& record, std::size_t& recordSize) const;
+
+    const std::uint8_t* bankData = nullptr;
+    std::size_t bankSize = 0;
+    int numPresets = 0;
+};
@@ -0,0 +1,350 @@
+/*
+  ==============================================================================
+
+    RealtimeAudit.cpp
+    Created: 17 Oct 2026 8:15:44pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "RealtimeAudit.h"
+
+#if RIBBON_REALTIME_AUDIT
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__) || defined(__APPLE__)
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+//==============================================================================
+// State. Everything is static and lock free, the hooks must never allocate.
+//==============================================================================
+thread_local int realtimeDepth = 0;
+thread_local int hookDepth = 0; // the audit itself may not be audited
+std::atomic<bool> abortOnViolation {false};
+std::atomic<std::uint64_t> counts[RealtimeAudit::numViolationTypes];
+
+struct CallSite
+{
+    std::atomic<void*> address;
+    std::atomic<std::uint64_t> count;
+    std::atomic<int> type;
+};
+const int MaxCallSites = 256;
+CallSite callSites[MaxCallSites];
+
+const char* const violationNames[RealtimeAudit::numViolationTypes] = {"allocation", "deallocation", "lock"};
+
+void WriteMessage(const char* message)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    auto length = 0;
+    while(message[length] != 0) length++;
+    auto written = write(2, message, (std::size_t) length);
+    (void) written;
+#else
+    std::fputs(message, stderr);
+#endif
+}
+
+void* Allocate(std::size_t size, void* callSite)
+{
+    if(realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::allocation, callSite);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* AllocateAligned(std::size_t size, std::size_t alignment, void* callSite)
+{
+    if(realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::allocation, callSite);
+    void* pointer = nullptr;
+#if defined(_WIN32)
+    pointer = _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+    if(posix_memalign(&pointer, alignment < sizeof(void*) ? sizeof(void*) : alignment, size == 0 ? 1 : size) != 0)
+    {
+        pointer = nullptr;
+    }
+#endif
+    return pointer;
+}
+
+void Free(void* pointer, void* callSite)
+{
+    if(pointer != nullptr && realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::deallocation, callSite);
+    std::free(pointer);
+}
+
+void FreeAligned(void* pointer, void* callSite)
+{
+    if(pointer != nullptr && realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::deallocation, callSite);
+#if defined(_WIN32)
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+}
+
+//==============================================================================
+// RealtimeAudit
+//==============================================================================
+RealtimeAudit::ScopedRealtimeSection::ScopedRealtimeSection() { realtimeDepth++; }
+RealtimeAudit::ScopedRealtimeSection::~ScopedRealtimeSection() { realtimeDepth--; }
+
+bool RealtimeAudit::IsEnabled() { return true; }
+bool RealtimeAudit::IsInRealtimeSection() { return realtimeDepth > 0; }
+void RealtimeAudit::SetAbortOnViolation(bool shouldAbort) { abortOnViolation = shouldAbort; }
+
+RealtimeAudit::Counts RealtimeAudit::GetCounts()
+{
+    return {counts[allocation].load(), counts[deallocation].load(), counts[lock].load()};
+}
+
+void RealtimeAudit::Reset()
+{
+    for(auto& count : counts) count = 0;
+    for(auto& site : callSites)
+    {
+        site.count = 0;
+        site.address = nullptr;
+    }
+}
+
+void RealtimeAudit::RecordViolation(ViolationType type, void* callSite)
+{
+    if(hookDepth > 0) return;
+    hookDepth++;
+
+    counts[type].fetch_add(1, std::memory_order_relaxed);
+    for(auto& site : callSites)
+    {
+        // use the first free slot, or the slot that already has this call site
+        void* address = nullptr;
+        if(site.address.compare_exchange_strong(address, callSite, std::memory_order_acq_rel))
+        {
+            site.type = type;
+        }
+        else if(address != callSite)
+        {
+            continue;
+        }
+        site.count.fetch_add(1, std::memory_order_relaxed);
+        break;
+    }
+    if(abortOnViolation)
+    {
+        WriteMessage("RealtimeAudit: ");
+        WriteMessage(violationNames[type]);
+        WriteMessage(" in a realtime section\n");
+        std::abort();
+    }
+    hookDepth--;
+}
+
+void RealtimeAudit::PrintReport(std::FILE* file)
+{
+    hookDepth++;
+    auto current = GetCounts();
+    std::fprintf(file, "RealtimeAudit: %llu allocations, %llu deallocations, %llu locks in realtime sections\n",
+                 (unsigned long long) current.allocations,
+                 (unsigned long long) current.deallocations,
+                 (unsigned long long) current.locks);
+    for(auto& site : callSites)
+    {
+        auto address = site.address.load();
+        if(address == nullptr) break;
+        const char* symbol = "?";
+        const char* object = "?";
+#if defined(__linux__) || defined(__APPLE__)
+        Dl_info info;
+        if(dladdr(address, &info) != 0)
+        {
+            if(info.dli_sname != nullptr) symbol = info.dli_sname;
+            if(info.dli_fname != nullptr) object = info.dli_fname;
+        }
+#endif
+        std::fprintf(file, "  %-12s x%-8llu %p %s (%s)\n",
+                     violationNames[site.type.load()],
+                     (unsigned long long) site.count.load(),
+                     address, symbol, object);
+    }
+    hookDepth--;
+}
+
+//==============================================================================
+// Global allocation functions
+//==============================================================================
+#if defined(_MSC_VER)
+ #include <intrin.h>
+ #define RIBBON_CALLSITE _ReturnAddress()
+#else
+ #define RIBBON_CALLSITE __builtin_return_address(0)
+#endif
+
+void* operator new(std::size_t size)
+{
+    if(auto* pointer = Allocate(size, RIBBON_CALLSITE)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size)
+{
+    if(auto* pointer = Allocate(size, RIBBON_CALLSITE)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size, RIBBON_CALLSITE); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size, RIBBON_CALLSITE); }
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if(auto* pointer = AllocateAligned(size, (std::size_t) alignment, RIBBON_CALLSITE)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if(auto* pointer = AllocateAligned(size, (std::size_t) alignment, RIBBON_CALLSITE)) return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { Free(pointer, RIBBON_CALLSITE); }
+void operator delete[](void* pointer) noexcept { Free(pointer, RIBBON_CALLSITE); }
+void operator delete(void* pointer, std::size_t) noexcept { Free(pointer, RIBBON_CALLSITE); }
+void operator delete[](void* pointer, std::size_t) noexcept { Free(pointer, RIBBON_CALLSITE); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { Free(pointer, RIBBON_CALLSITE); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { Free(pointer, RIBBON_CALLSITE); }
+void operator delete(void* pointer, std::align_val_t) noexcept { FreeAligned(pointer, RIBBON_CALLSITE); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { FreeAligned(pointer, RIBBON_CALLSITE); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { FreeAligned(pointer, RIBBON_CALLSITE); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { FreeAligned(pointer, RIBBON_CALLSITE); }
+
+//==============================================================================
+// Locks. std::mutex and juce::CriticalSection lock a pthread mutex, juce::ReadWriteLock
+// and std::shared_mutex a pthread rwlock. A juce::SpinLock that is taken by another
+// thread yields until it is free, so it is counted by sched_yield (taking a free
+// SpinLock is one atomic exchange, which can not be hooked). The calls are passed
+// on to the functions of the C library.
+//==============================================================================
+#if defined(__linux__)
+namespace
+{
+template <typename Function>
+Function NextFunction(std::atomic<Function>& next, const char* name)
+{
+    auto function = next.load(std::memory_order_acquire);
+    if(function == nullptr)
+    {
+        function = (Function) dlsym(RTLD_NEXT, name);
+        next.store(function, std::memory_order_release);
+    }
+    return function;
+}
+using MutexLockFunction = int (*)(pthread_mutex_t*);
+using RwLockFunction = int (*)(pthread_rwlock_t*);
+using YieldFunction = int (*)();
+std::atomic<MutexLockFunction> nextMutexLock {nullptr};
+std::atomic<RwLockFunction> nextReadLock {nullptr};
+std::atomic<RwLockFunction> nextWriteLock {nullptr};
+std::atomic<YieldFunction> nextYield {nullptr};
+}
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    if(realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::lock, RIBBON_CALLSITE);
+    return NextFunction(nextMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+extern "C" int pthread_rwlock_rdlock(pthread_rwlock_t* rwlock)
+{
+    if(realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::lock, RIBBON_CALLSITE);
+    return NextFunction(nextReadLock, "pthread_rwlock_rdlock")(rwlock);
+}
+
+extern "C" int pthread_rwlock_wrlock(pthread_rwlock_t* rwlock)
+{
+    if(realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::lock, RIBBON_CALLSITE);
+    return NextFunction(nextWriteLock, "pthread_rwlock_wrlock")(rwlock);
+}
+
+extern "C" int sched_yield() noexcept
+{
+    if(realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::lock, RIBBON_CALLSITE);
+    return NextFunction(nextYield, "sched_yield")();
+}
+
+#elif defined(__APPLE__)
+// dyld replaces the functions for every image that calls them, when the image with the
+// __interpose section is loaded at launch: the command line tools, or the plugin built as
+// a Standalone app. Calls from this file go to the original functions.
+#include <os/lock.h>
+#include <sched.h>
+
+#define RIBBON_INTERPOSE(replacement, original) \
+    __attribute__((used)) static const struct { const void* replacementFunction; const void* originalFunction; } \
+    interpose_##original __attribute__((section("__DATA,__interpose"))) = { (const void*) &replacement, (const void*) &original }
+
+namespace
+{
+int AuditMutexLock(pthread_mutex_t* mutex)
+{
+    if(realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::lock, RIBBON_CALLSITE);
+    return pthread_mutex_lock(mutex);
+}
+
+int AuditReadLock(pthread_rwlock_t* rwlock)
+{
+    if(realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::lock, RIBBON_CALLSITE);
+    return pthread_rwlock_rdlock(rwlock);
+}
+
+int AuditWriteLock(pthread_rwlock_t* rwlock)
+{
+    if(realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::lock, RIBBON_CALLSITE);
+    return pthread_rwlock_wrlock(rwlock);
+}
+
+void AuditUnfairLock(os_unfair_lock_t lock)
+{
+    if(realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::lock, RIBBON_CALLSITE);
+    os_unfair_lock_lock(lock);
+}
+
+int AuditYield()
+{
+    if(realtimeDepth > 0) RealtimeAudit::RecordViolation(RealtimeAudit::lock, RIBBON_CALLSITE);
+    return sched_yield();
+}
+}
+
+RIBBON_INTERPOSE(AuditMutexLock, pthread_mutex_lock);
+RIBBON_INTERPOSE(AuditReadLock, pthread_rwlock_rdlock);
+RIBBON_INTERPOSE(AuditWriteLock, pthread_rwlock_wrlock);
+RIBBON_INTERPOSE(AuditUnfairLock, os_unfair_lock_lock);
+RIBBON_INTERPOSE(AuditYield, sched_yield);
+#endif
+
+#else
+
+//==============================================================================
+// Audit disabled: nothing is replaced and nothing is counted.
+//==============================================================================
+RealtimeAudit::ScopedRealtimeSection::ScopedRealtimeSection() {}
+RealtimeAudit::ScopedRealtimeSection::~ScopedRealtimeSection() {}
+
+bool RealtimeAudit::IsEnabled() { return false; }
+bool RealtimeAudit::IsInRealtimeSection() { return false; }
+void RealtimeAudit::SetAbortOnViolation(bool) {}
+RealtimeAudit::Counts RealtimeAudit::GetCounts() { return {0, 0, 0}; }
+void RealtimeAudit::Reset() {}
+void RealtimeAudit::PrintReport(std::FILE* file)
+{
+    std::fprintf(file, "RealtimeAudit: not enabled in this build (RIBBON_REALTIME_AUDIT)\n");
+}
+void RealtimeAudit::RecordViolation(ViolationType, void*) {}
+
+#endif
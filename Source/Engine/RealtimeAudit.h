@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    RealtimeAudit.h
+    Created: 17 Oct 2026 8:15:44pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+
+//==============================================================================
+// Finds allocations and locks on the audio thread.
+//
+// Only active when built with RIBBON_REALTIME_AUDIT=1 (cmake option
+// RIBBON_REALTIME_AUDIT, or the RealtimeAudit configuration of the Projucer
+// project). The audit build replaces the global operator new and delete, and
+// hooks the pthread mutex and rwlock locks (std::mutex, juce::CriticalSection,
+// juce::ReadWriteLock), os_unfair_lock on macOS, and sched_yield, which is
+// where a juce::SpinLock that is taken waits. On Linux the functions are
+// replaced, on macOS they are interposed by dyld (DYLD_INTERPOSE), which only
+// covers code that is loaded when the program starts.
+//
+// Code between RIBBON_REALTIME_SECTION() and the end of its scope is
+// realtime code: every allocation, free and lock in it on that thread is
+// counted together with its call site, or aborts the program when
+// SetAbortOnViolation(true) was called.
+//
+// Without RIBBON_REALTIME_AUDIT the macro is empty and nothing is replaced.
+//
+// The engine is audited by RibbonRealtimeStress (ctest in a build with
+// RIBBON_REALTIME_AUDIT=ON). The plugin itself, with processBlock, the midi
+// that is passed on and the learned controls, is audited by a run of the
+// RealtimeAudit configuration as a Standalone app (add the Standalone format
+// in the Projucer, so the plugin code is in the executable dyld starts):
+// play the ribbon, learned controls, program changes and midi learn, and
+// quit. The processor prints the report when it is deleted.
+//==============================================================================
+class RealtimeAudit
+{
+public:
+    enum ViolationType { allocation = 0, deallocation, lock, numViolationTypes };
+
+    struct Counts
+    {
+        std::uint64_t allocations;
+        std::uint64_t deallocations;
+        std::uint64_t locks;
+        std::uint64_t total() const { return allocations + deallocations + locks; }
+    };
+
+    class ScopedRealtimeSection
+    {
+    public:
+        ScopedRealtimeSection();
+        ~ScopedRealtimeSection();
+        ScopedRealtimeSection(const ScopedRealtimeSection&) = delete;
+        ScopedRealtimeSection& operator=(const ScopedRealtimeSection&) = delete;
+    };
+
+    static bool IsEnabled();
+    static bool IsInRealtimeSection();
+    static void SetAbortOnViolation(bool shouldAbort);
+    static Counts GetCounts();
+    static void Reset();
+
+    // writes the counts and the call sites with the number of violations each
+    static void PrintReport(std::FILE* file);
+
+    // called by the hooks
+    static void RecordViolation(ViolationType type, void* callSite);
+};
+
+#if RIBBON_REALTIME_AUDIT
+ #define RIBBON_REALTIME_SECTION() RealtimeAudit::ScopedRealtimeSection realtimeSection
+#else
+ #define RIBBON_REALTIME_SECTION()
+#endif
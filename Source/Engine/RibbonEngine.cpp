@@ -0,0 +1,254 @@
+/*
+  ==============================================================================
+
+    RibbonEngine.cpp
+    Created: 17 Oct 2026 5:48:03pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "RibbonEngine.h"
+
+void RibbonEngine::Prepare(double sampleRate, int samplesPerBlock)
+{
+    // the queue must be large enough for everything that can be created in one block
+    notesToPlayQueue.prepare(samplesPerBlock > MidiQueueMinCapacity ? samplesPerBlock : MidiQueueMinCapacity);
+    currentSampleRate = sampleRate;
+    preparedBlockSize = samplesPerBlock;
+    deliveryScheduler.reset();
+}
+
+void RibbonEngine::Reset()
+{
+    notesToPlayQueue.clear();
+    soundingNotes.Clear();
+    deliveryScheduler.reset();
+    activeZone = 0;
+    pendingZone = NOZONE;
+}
+
+void RibbonEngine::BeginBlock(const EngineConfig& newConfig, int newActiveProgression, std::uint8_t newVelocity, const DeliveryPolicy& policy)
+{
+    config = &newConfig;
+    SetActiveProgression(newActiveProgression);
+    velocity = newVelocity;
+    deliveryScheduler.setPolicy(policy);
+    if(config->preset.serial != presetSerial)
+    {
+        presetSerial = config->preset.serial;
+        StopAllSoundingNotes(0);
+    }
+}
+
+void RibbonEngine::SetConfig(const EngineConfig& newConfig, int samplePosition)
+{
+    // a zone that waited for the minimum dwell time before this sample is still played with the previous config
+    PlayPendingZone(samplePosition);
+    config = &newConfig;
+    SetActiveProgression(config->preset.activeProgression);
+    velocity = config->preset.velocity;
+    noteOffset = config->preset.noteOffset;
+    if(config->preset.serial != presetSerial)
+    {
+        presetSerial = config->preset.serial;
+        StopAllSoundingNotes(samplePosition);
+    }
+}
+
+void RibbonEngine::SetActiveProgression(int progression)
+{
+    activeProgression = progression < 0 ? 0 : progression >= MAX_PROGRESSIONS ? MAX_PROGRESSIONS - 1 : progression;
+}
+
+//==============================================================================
+// Ribbon
+//==============================================================================
+bool RibbonEngine::HandleMidi(const std::uint8_t* data, int size, int samplePosition)
+{
+    PlayPendingZone(samplePosition);
+
+    //ccval linked to the ribbon? Then play notes or stop playing notes based on the cc value,
+    //at the same sample as the cc message, so every zone that is crossed within the block is played.
+    if(size == 3 && (data[0] & 0xf0) == 0xb0 && data[1] == config->midiCC)
+    {
+        lastCCValue = data[2];
+        HandleRibbonValue(data[2], (data[0] & 0x0f) + 1, samplePosition);
+        return true;
+    }
+    return false;
+}
+
+// select the zone for a ribbon value. With a minimum dwell time, a new zone is only played
+// when the ribbon stays in it long enough. Stopping the notes (zone 0) is never delayed.
+void RibbonEngine::HandleRibbonValue(int ccval, int channel, int samplePosition)
+{
+    int zone = config->zones.Classify(ccval, activeZone);
+
+    if(zone == NOZONE || zone == activeZone || zone == 0 || GetDwellSamples() == 0)
+    {
+        pendingZone = NOZONE;
+        if(zone != activeZone)
+        {
+            PlayZone(zone, channel, samplePosition);
+        }
+        return;
+    }
+    if(zone != pendingZone)
+    {
+        pendingZone = zone;
+        pendingChannel = channel;
+        pendingSince = blockStartSample + samplePosition;
+    }
+}
+
+void RibbonEngine::PlayValue(int ccval, int channel, int samplePosition)
+{
+    PlayZone(config->zones.ZoneForValue(ccval), channel, samplePosition);
+}
+
+// play the pending zone if it has been selected for the minimum dwell time before the given sample.
+void RibbonEngine::PlayPendingZone(int samplePosition)
+{
+    if(pendingZone == NOZONE) return;
+
+    auto playAt = pendingSince + GetDwellSamples() - blockStartSample;
+    if(playAt <= samplePosition)
+    {
+        auto zone = pendingZone;
+        pendingZone = NOZONE;
+        PlayZone(zone, pendingChannel, (int) (playAt > 0 ? playAt : 0));
+    }
+}
+
+std::int64_t RibbonEngine::GetDwellSamples() const
+{
+    return (std::int64_t) (config->minimumDwellMs * currentSampleRate / 1000.0);
+}
+
+void RibbonEngine::PlayZone(int zone, int channel, int samplePosition)
+{
+    // if listening to specific channels and channel is not the same, do nothing
+    if(config->channelIn != 0 && channel != config->channelIn)
+    {
+        return;
+    }
+    
+    // if specific channel out has been set, change the channel
+    if(config->channelOut != 0)
+    {
+        channel = config->channelOut;
+    }
+    
+    if(zone == 0)
+    {
+        AddPreviousNotesSentNotesOff(samplePosition);
+        activeZone = 0;
+    }
+    //only do something if the same note is not already pressed
+    else if(zone != NOZONE && activeZone != zone)
+    {
+        activeZone = zone;
+        if(config->legato)
+        {
+            //only stop the notes that are not in the new chord and start the notes that are new
+            AddChangedNotes(zone-1, channel, samplePosition);
+        }
+        else
+        {
+            //first sent noteOff for previous notes.
+            AddPreviousNotesSentNotesOff(samplePosition);
+            //create new noteOn
+            AddSentNotesOn(zone-1, channel, samplePosition);
+        }
+    }
+}
+
+//==============================================================================
+// Notes
+//==============================================================================
+// add notes off for every note that is still sounding, on the channel it was played on
+void RibbonEngine::AddPreviousNotesSentNotesOff(int samplePosition)
+{
+    soundingNotes.ForEachSounding([&](int channel, int note)
+    {
+        AddNoteOff(channel, note, samplePosition);
+    });
+}
+
+// stop a note in the configured note off style
+void RibbonEngine::AddNoteOff(int channel, int note, int samplePosition)
+{
+    // a note that is still waiting for the delivery policy is dropped together with its note off,
+    // so the backlog of a long ribbon sweep does not grow with every zone it crosses. When the policy
+    // holds back events, notes of this block that are stopped before they are played are dropped too.
+    if(notesToPlayQueue.removeNoteOn(channel, note, ! deliveryScheduler.holdsBackEvents(preparedBlockSize)))
+    {
+        soundingNotes.NoteOff(channel, note);
+        return;
+    }
+    if(config->noteOffStyle != NoteOffStyle::noteOff)
+    {
+        notesToPlayQueue.push(MidiEvent::noteOn(channel, note, 0, samplePosition));
+    }
+    if(config->noteOffStyle != NoteOffStyle::zeroVelocityNoteOn)
+    {
+        notesToPlayQueue.push(MidiEvent::noteOff(channel, note, samplePosition));
+    }
+    soundingNotes.NoteOff(channel, note);
+}
+
+void RibbonEngine::AddNoteOn(int channel, int note, int samplePosition)
+{
+    notesToPlayQueue.push(MidiEvent::noteOn(channel, note, velocity, samplePosition));
+    soundingNotes.NoteOn(channel, note);
+}
+
+// legato chord change: stop the notes that are not in the new chord and only start the notes
+// that are not sounding yet. Notes both chords have in common keep playing without a retrigger.
+void RibbonEngine::AddChangedNotes(int selectedZone, int channel, int samplePosition)
+{
+    bool inNewChord[128] = {};
+    const std::int8_t* chord = config->chords.notes[activeProgression][selectedZone];
+
+    for(int j=0;j<MAX_NOTES && chord[j]!=NONOTE;j++)
+    {
+        int note = chord[j] + noteOffset;
+        if(note >= 0 && note < 128)
+        {
+            inNewChord[note] = true;
+        }
+    }
+    soundingNotes.ForEachSounding([&](int soundingChannel, int note)
+    {
+        if(soundingChannel != channel || !inNewChord[note])
+        {
+            AddNoteOff(soundingChannel, note, samplePosition);
+        }
+    });
+    AddSentNotesOn(selectedZone, channel, samplePosition);
+}
+
+// add notes on for the selected zone on the given channel. Notes that are already sounding are not started again.
+void RibbonEngine::AddSentNotesOn(int selectedZone, int channel, int samplePosition)
+{
+    //loop through array
+    for(int j=0;j<MAX_NOTES;j++)
+    {
+        int note = config->chords.notes[activeProgression][selectedZone][j];
+        if(note==NONOTE) break;
+        note += noteOffset;
+        if(note < 0 || note > 127) continue;
+        if(!soundingNotes.IsSounding(channel, note))
+        {
+            AddNoteOn(channel, note, samplePosition);
+        }
+    }
+}
+
+void RibbonEngine::StopAllSoundingNotes(int samplePosition)
+{
+    AddPreviousNotesSentNotesOff(samplePosition);
+    activeZone = 0;
+    pendingZone = NOZONE;
+}
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    RibbonEngine.h
+    Created: 17 Oct 2026 5:48:03pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include "EngineDefines.h"
+#include "EngineConfig.h"
+#include "MidiEventQueue.h"
+#include "NoteTracker.h"
+#include "DeliveryScheduler.h"
+
+const int MidiQueueMinCapacity = 1024;
+
+//==============================================================================
+// Turns ribbon cc messages into chords. This is the part of the plugin that
+// runs on the audio thread, without JUCE, so it can also be built and tested
+// on its own (see CMakeLists.txt).
+//
+// For every block:
+//   BeginBlock(config, ...)           settings used for the whole block
+//   HandleMidi(...) for each message  true when it was the ribbon cc
+//   EndBlock(numSamples, output)      output(event, samplePosition) is called
+//                                     for every midi event of the block
+//
+// Prepare allocates the queue, nothing else allocates.
+//==============================================================================
+class RibbonEngine
+{
+public:
+    RibbonEngine() { Prepare(44100.0, MidiQueueMinCapacity); }
+
+    void Prepare(double sampleRate, int samplesPerBlock);
+
+    // forgets what is playing, without sending note offs
+    void Reset();
+
+    // the config must stay valid until EndBlock is called. The notes of the previous config are
+    // stopped at the start of the block when the config belongs to another preset.
+    void BeginBlock(const EngineConfig& config, int activeProgression, std::uint8_t velocity, const DeliveryPolicy& policy);
+
+    // switches to another config within the block, e.g. a preset selected by a program change. From the
+    // sample position on, the config and the progression, velocity and note offset of its preset are used. The notes of
+    // the previous preset are stopped at that sample. The config must stay valid until EndBlock is called.
+    void SetConfig(const EngineConfig& newConfig, int samplePosition);
+
+    // settings that can also change within a block, e.g. by a learned midi control
+    void SetActiveProgression(int progression);
+    void SetVelocity(std::uint8_t newVelocity) { velocity = newVelocity; }
+    // semitones added to the notes of the chords when they are started. Sounding notes keep their
+    // pitch, the offset is heard from the next chord on. Notes that end up outside 0..127 are not played.
+    void SetNoteOffset(int semitones) { noteOffset = semitones; }
+
+    // handles the message when it is the ribbon cc. Returns false for every other message.
+    bool HandleMidi(const std::uint8_t* data, int size, int samplePosition);
+
+    // a ribbon value, with hysteresis and minimum dwell time
+    void HandleRibbonValue(int ccval, int channel, int samplePosition);
+
+    // plays the zone of the value right away, e.g. for a zone that is clicked in the editor
+    void PlayValue(int ccval, int channel, int samplePosition);
+
+    // stops every sounding note. The chord of the active zone is played again by the next ribbon message.
+    void StopAllSoundingNotes(int samplePosition);
+
+    // plays the pending zone and passes the events of this block to output(const MidiEvent&, int samplePosition).
+    // Returns the largest delay the delivery policy gave to an event, in samples.
+    template <typename Output>
+    int EndBlock(int numSamples, Output&& output)
+    {
+        PlayPendingZone(numSamples - 1);
+        blockStartSample += numSamples;
+        return deliveryScheduler.deliver(notesToPlayQueue, numSamples, output);
+    }
+
+    // drops the queued note ons and passes the queued note offs and note offs for all sounding notes
+    // to output at sample 0, e.g. when the plugin is bypassed. A queued note off is not dropped: its
+    // note is no longer sounding for the tracker, so nothing else would stop it.
+    template <typename Output>
+    void Flush(int numSamples, Output&& output)
+    {
+        MidiEvent event;
+        while(notesToPlayQueue.pop(event))
+        {
+            if((event.data[0] & 0xf0) == 0x90 && event.data[2] > 0)
+            {
+                soundingNotes.NoteOff((event.data[0] & 0x0f) + 1, event.data[1]);
+                continue;
+            }
+            output(event, 0);
+        }
+        deliveryScheduler.reset();
+        StopAllSoundingNotes(0);
+        while(notesToPlayQueue.pop(event))
+        {
+            output(event, 0);
+        }
+        blockStartSample += numSamples;
+    }
+
+    int GetActiveZone() const { return activeZone; }
+    int GetLastCCValue() const { return lastCCValue; }
+    const NoteTracker& GetSoundingNotes() const { return soundingNotes; }
+    const MidiEventQueue& GetQueue() const { return notesToPlayQueue; }
+    std::uint32_t GetOverflowCount() const { return notesToPlayQueue.getOverflowCount(); }
+
+private:
+    void PlayPendingZone(int samplePosition);
+    void PlayZone(int zone, int channel, int samplePosition);
+    void AddPreviousNotesSentNotesOff(int samplePosition);
+    void AddSentNotesOn(int selectedZone, int channel, int samplePosition);
+    void AddChangedNotes(int selectedZone, int channel, int samplePosition);
+    void AddNoteOff(int channel, int note, int samplePosition);
+    void AddNoteOn(int channel, int note, int samplePosition);
+    std::int64_t GetDwellSamples() const;
+
+    const EngineConfig* config = nullptr; // config used for the current block
+    std::uint32_t presetSerial = 0;
+    int activeProgression = 0;
+    std::uint8_t velocity = 100;
+    int noteOffset = 0;
+
+    int activeZone = 0;
+    int lastCCValue = 0;
+
+    // zone that waits for the minimum dwell time before it is played
+    int pendingZone = NOZONE;
+    int pendingChannel = 1;
+    std::int64_t pendingSince = 0;
+    std::int64_t blockStartSample = 0; // number of samples processed before the current block
+    double currentSampleRate = 44100.0;
+    int preparedBlockSize = 512;
+
+    MidiEventQueue notesToPlayQueue;
+    NoteTracker soundingNotes; // notes sent by the ribbon that have not been stopped yet
+    DeliveryScheduler deliveryScheduler;
+};
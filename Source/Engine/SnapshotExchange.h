@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    SnapshotExchange.h
+    Created: 17 Oct 2026 11:20:33am
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <mutex>
+
+//==============================================================================
+// Hands complete snapshots from the message thread to the audio thread.
+//
+// There are three slots: one owned by the writer, one owned by the reader and
+// one in the middle. Publishing swaps the writer slot with the middle one,
+// acquiring swaps the middle slot with the reader one. Both are a single atomic
+// exchange, so the reader never waits, never allocates and always sees a
+// snapshot that was completely written. A snapshot stays valid for the reader
+// until it calls acquire again.
+//
+// Writers are serialised with a mutex, so snapshots may be published from more
+// than one (non realtime) thread. There must be only one reader.
+//==============================================================================
+template <typename SnapshotType>
+class SnapshotExchange
+{
+public:
+    // fills all slots, so the reader has a valid snapshot before anything is published.
+    void reset(const SnapshotType& snapshot)
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        for(auto& slot : slots)
+        {
+            slot = snapshot;
+        }
+    }
+
+    // writer side
+    void publish(const SnapshotType& snapshot)
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        slots[writeIndex] = snapshot;
+        writeIndex = middle.exchange(writeIndex | newSnapshotFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // reader side (audio thread). Call once per block and use the result for the whole block.
+    const SnapshotType& acquire()
+    {
+        if(middle.load(std::memory_order_acquire) & newSnapshotFlag)
+        {
+            readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        }
+        return slots[readIndex];
+    }
+
+    // the snapshot the reader got with the last call to acquire.
+    const SnapshotType& current() const { return slots[readIndex]; }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int newSnapshotFlag = 4;
+
+    SnapshotType slots[3];
+    std::atomic<int> middle {1};
+    int writeIndex = 0;
+    int readIndex = 2;
+    std::mutex writerMutex;
+};
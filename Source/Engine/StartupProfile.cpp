@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    StartupProfile.cpp
+    Created: 17 Oct 2026 11:34:52pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "StartupProfile.h"
+#include <atomic>
+#include <chrono>
+
+namespace
+{
+// all instances of the plugin in the process share the times
+std::atomic<std::uint64_t> counts[StartupProfile::numStages];
+std::atomic<std::int64_t> totalNanoseconds[StartupProfile::numStages];
+std::atomic<std::int64_t> maxNanoseconds[StartupProfile::numStages];
+
+const char* const stageNames[StartupProfile::numStages] = {"parameter layout", "constructor", "setStateInformation", "getStateInformation", "createEditor"};
+
+std::int64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+//==============================================================================
+StartupProfile::ScopedTimer::ScopedTimer(Stage stageToMeasure) : stage(stageToMeasure), start(Now()) {}
+StartupProfile::ScopedTimer::~ScopedTimer() { Record(stage, (double) (Now() - start) * 1.0e-6); }
+
+StartupProfile::Stopwatch::Stopwatch() : start(Now()) {}
+void StartupProfile::Stopwatch::Record(Stage stage) const { StartupProfile::Record(stage, (double) (Now() - start) * 1.0e-6); }
+
+bool StartupProfile::IsEnabled()
+{
+#if RIBBON_STARTUP_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void StartupProfile::Record(Stage stage, double milliseconds)
+{
+    auto nanoseconds = (std::int64_t) (milliseconds * 1.0e6);
+    counts[stage].fetch_add(1, std::memory_order_relaxed);
+    totalNanoseconds[stage].fetch_add(nanoseconds, std::memory_order_relaxed);
+    auto max = maxNanoseconds[stage].load(std::memory_order_relaxed);
+    while(nanoseconds > max && ! maxNanoseconds[stage].compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+StartupProfile::Times StartupProfile::GetTimes(Stage stage)
+{
+    return {counts[stage].load(), (double) totalNanoseconds[stage].load() * 1.0e-6, (double) maxNanoseconds[stage].load() * 1.0e-6};
+}
+
+const char* StartupProfile::GetStageName(Stage stage)
+{
+    return stageNames[stage];
+}
+
+void StartupProfile::Reset()
+{
+    for(int stage=0;stage<numStages;stage++)
+    {
+        counts[stage] = 0;
+        totalNanoseconds[stage] = 0;
+        maxNanoseconds[stage] = 0;
+    }
+}
+
+void StartupProfile::PrintReport(std::FILE* file)
+{
+    std::uint64_t recorded = 0;
+    for(auto& count : counts) recorded += count.load();
+    if(recorded == 0 && ! IsEnabled())
+    {
+        std::fprintf(file, "StartupProfile: not enabled in this build (RIBBON_STARTUP_PROFILE)\n");
+        return;
+    }
+    std::fprintf(file, "StartupProfile:\n");
+    for(int stage=0;stage<numStages;stage++)
+    {
+        auto times = GetTimes((Stage) stage);
+        if(times.count == 0) continue;
+        std::fprintf(file, "  %-20s x%-4llu total %9.3f ms  mean %8.3f ms  max %8.3f ms\n",
+                     stageNames[stage], (unsigned long long) times.count,
+                     times.totalMs, times.totalMs / (double) times.count, times.maxMs);
+    }
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    StartupProfile.h
+    Created: 17 Oct 2026 11:34:52pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+
+//==============================================================================
+// Measures the time the plugin spends in the steps of opening a session:
+// creating the parameters, the constructor, loading the state and creating
+// the editor.
+//
+// Only active when built with RIBBON_STARTUP_PROFILE=1 (a preprocessor
+// definition in the Projucer). The times of all instances in the process
+// are added up, so a session with many instances shows the total. The
+// processor prints the report when it is deleted.
+//
+// Without RIBBON_STARTUP_PROFILE the macros are empty.
+//==============================================================================
+class StartupProfile
+{
+public:
+    enum Stage { parameterLayout = 0, constructor, setState, getState, createEditor, numStages };
+
+    struct Times
+    {
+        std::uint64_t count;
+        double totalMs;
+        double maxMs;
+    };
+
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Stage stageToMeasure);
+        ~ScopedTimer();
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    private:
+        Stage stage;
+        std::int64_t start;
+    };
+
+    // for a stage that does not end in the scope it starts in: the processor
+    // derives from it first, so the constructor is measured from before the
+    // base classes and members (the parameters) are created
+    class Stopwatch
+    {
+    public:
+        Stopwatch();
+        void Record(Stage stage) const;
+    private:
+        std::int64_t start;
+    };
+
+    static bool IsEnabled();
+    static void Record(Stage stage, double milliseconds);
+    static Times GetTimes(Stage stage);
+    static const char* GetStageName(Stage stage);
+    static void Reset();
+    static void PrintReport(std::FILE* file);
+};
+
+#if RIBBON_STARTUP_PROFILE
+ #define RIBBON_STARTUP_TIMER(stage) StartupProfile::ScopedTimer startupTimer(StartupProfile::stage)
+ #define RIBBON_STARTUP_RECORD(stopwatch, stage) (stopwatch).Record(StartupProfile::stage)
+#else
+ #define RIBBON_STARTUP_TIMER(stage)
+ #define RIBBON_STARTUP_RECORD(stopwatch, stage)
+#endif
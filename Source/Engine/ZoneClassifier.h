@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    ZoneClassifier.h
+    Created: 17 Oct 2026 1:41:09pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include "EngineDefines.h"
+
+const int NOZONE = -1;
+
+//==============================================================================
+// Maps a ribbon cc value to a zone with a lookup table.
+// Zone 0 is the zone that stops the notes, zones 1..numberOfZones play the
+// chords. Values above the last split do not select a zone (NOZONE).
+//
+// With hysteresis, the current zone is kept until the value is more than the
+// band of the boundary it crosses outside of it, so a noisy ribbon does not
+// chatter between two zones. Every boundary between two chord zones has its
+// own band, which is never wider than either zone minus one step: a narrow
+// zone can always be reached from both sides. Moving to zone 0 is never
+// delayed, so releasing the ribbon always stops the notes immediately.
+//==============================================================================
+class ZoneClassifier
+{
+public:
+    // the same band for every boundary
+    void Build(const int splitValues[MAX_SPLITS], int numberOfZones, int hysteresisSteps)
+    {
+        int bands[MAX_SPLITS];
+        for(auto& band : bands)
+        {
+            band = hysteresisSteps;
+        }
+        Build(splitValues, numberOfZones, bands);
+    }
+
+    // bands[zone] is the band of the boundary between zone and zone + 1, in cc steps
+    void Build(const int splitValues[MAX_SPLITS], int numberOfZones, const int bands[MAX_SPLITS])
+    {
+        for(int zone=0;zone<=MAX_ZONES;zone++)
+        {
+            zoneLower[zone] = 128;
+            zoneUpper[zone] = 0;
+        }
+        for(int value=0;value<128;value++)
+        {
+            int selectedZone = NOZONE;
+            for(int zone=0 ; zone < numberOfZones ;zone++)
+            {
+                if(value <= splitValues[0])
+                {
+                    selectedZone = 0;
+                    break;
+                }
+                //if value is in range according to splitValues array, the zone is found
+                if(value < splitValues[zone+1])
+                {
+                    selectedZone = zone+1;
+                    break;
+                }
+            }
+            zoneForValue[value] = (std::int8_t) selectedZone;
+            if(selectedZone != NOZONE)
+            {
+                zoneLower[selectedZone] = value < zoneLower[selectedZone] ? value : zoneLower[selectedZone];
+                zoneUpper[selectedZone] = value + 1 > zoneUpper[selectedZone] ? value + 1 : zoneUpper[selectedZone];
+            }
+        }
+        // the values the current zone is kept for. The boundary to zone 0 has no band.
+        for(int zone=0;zone<=MAX_ZONES;zone++)
+        {
+            holdLower[zone] = zoneLower[zone];
+            holdUpper[zone] = zoneUpper[zone];
+        }
+        for(int zone=1;zone<MAX_ZONES;zone++)
+        {
+            const auto band = LimitBand(zone, bands[zone]);
+            holdUpper[zone] += band;
+            holdLower[zone+1] -= band;
+        }
+    }
+
+    // zone without hysteresis
+    int ZoneForValue(int ccval) const
+    {
+        return zoneForValue[ccval & 0x7f];
+    }
+
+    // zone, taking the hysteresis around the current zone into account
+    int Classify(int ccval, int currentZone) const
+    {
+        int zone = ZoneForValue(ccval);
+        if(zone > 0 && currentZone > 0 && zone != currentZone)
+        {
+            if(ccval >= holdLower[currentZone] && ccval < holdUpper[currentZone])
+            {
+                return currentZone;
+            }
+        }
+        return zone;
+    }
+
+    // band of the boundary between zone and zone + 1, as it is used
+    int GetBand(int zone) const { return zone > 0 && zone < MAX_ZONES ? holdUpper[zone] - zoneUpper[zone] : 0; }
+
+private:
+    // the band, limited to one step less than the zones on both sides of the boundary
+    int LimitBand(int zone, int band) const
+    {
+        const auto width = zoneUpper[zone] - zoneLower[zone];
+        const auto nextWidth = zoneUpper[zone+1] - zoneLower[zone+1];
+        band = band < width - 1 ? band : width - 1;
+        band = band < nextWidth - 1 ? band : nextWidth - 1;
+        return band > 0 ? band : 0;
+    }
+
+    std::int8_t zoneForValue[128];
+    int zoneLower[MAX_ZONES+1];  // lowest value of the zone
+    int zoneUpper[MAX_ZONES+1];  // highest value of the zone + 1
+    int holdLower[MAX_ZONES+1];  // lowest value the zone is kept for when it is the current zone
+    int holdUpper[MAX_ZONES+1];  // highest value the zone is kept for + 1
+};
@@ -24,23 +24,18 @@ KeyZone::~KeyZone()
 {
     RemoveListeners();
     cmbKeysAttachment = nullptr;
-    for(int j=0;j<MAX_NOTES;j++)
-    {
-        sldChordNotesHelpAttachment[j]=nullptr;
-        sldNotesToPlayHelpAttachment[j]=nullptr;
-    }
 }
 
 void KeyZone::CreateGui()
 {
     addAndMakeVisible(cmbKey);
     cmbKey.addItemList(keysArray, 1);
-    cmbKeysAttachment= std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, KEYS_ID + std::to_string(PROGRESSION_ID) + "_" + std::to_string(ZONE_ID), cmbKey);
+    cmbKeysAttachment= std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, GetParameterID(ParameterKind::keys, PROGRESSION_ID, ZONE_ID), cmbKey);
     cmbKey.setEnabled(true);
     
     addAndMakeVisible(cmbChord);
     cmbChord.addItemList(chordsArray, 1);
-    cmbChordsAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, CHORDS_ID + std::to_string(PROGRESSION_ID) + "_" + std::to_string(ZONE_ID), cmbChord);
+    cmbChordsAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, GetParameterID(ParameterKind::chords, PROGRESSION_ID, ZONE_ID), cmbChord);
     cmbChord.setEnabled(true);
     
     
@@ -51,23 +46,12 @@ void KeyZone::CreateGui()
     SetChordStringText();
     
     edtChordChanged=false;
-    
-    for(int j=0;j<MAX_NOTES;j++)
-    {
-        addAndMakeVisible(sldChordNotesHelp[j]);
-        sldChordNotesHelp[j].setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
-        sldChordNotesHelpAttachment[j] = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, CHORDBUILDS_ID + std::to_string(PROGRESSION_ID) + "_" + std::to_string(ZONE_ID) + "_" + std::to_string(j), sldChordNotesHelp[j]);
-    }
 }
 
 void KeyZone::AddListeners()
 {
     cmbKey.addListener(this);
     cmbChord.addListener(this);
-    for(int j=0;j<MAX_NOTES;j++)
-    {
-        sldChordNotesHelp[j].addListener(this);
-    }
     edtChordBuilder.onTextChange = [this] {EdtChordBuilderOnChange();};
 }
 
@@ -75,10 +59,6 @@ void KeyZone::RemoveListeners()
 {
     cmbKey.removeListener(this);
     cmbChord.removeListener(this);
-    for(int j=0;j<MAX_NOTES;j++)
-    {
-        sldChordNotesHelp[j].removeListener(this);
-    }
     edtChordBuilder.onTextChange = nullptr;
 }
 void KeyZone::resized()
@@ -133,8 +113,7 @@ void KeyZone::SetSelectedChord()
             juce::String sep = "";
             for(int j=0;j<MAX_NOTES;j++)
             {
-                int notenr = sldChordNotesHelp[j].getValue();
-                audioProcessor.UpdateParameter(notenr, CHORDBUILDS_ID + std::to_string(PROGRESSION_ID) + "_" + std::to_string(ZONE_ID) + "_" + std::to_string(j));
+                int notenr = audioProcessor.GetChordNote(PROGRESSION_ID, ZONE_ID, j);
                 if(notenr != NONOTE)
                 {
                     chord = chord + sep + std::to_string(notenr);
@@ -149,16 +128,18 @@ void KeyZone::SetSelectedChord()
             edtChordChanged=false;
         }
     }
-    BuildChords();
 }
 
 void KeyZone::EdtChordBuilderOnChange()
 {
     if(Service::PresetManager::PresetLoading !=  Service::ePresetLoading::notLoading) return;
     edtChordChanged = true;
-    audioProcessor.UpdateParameter(chordbuildsArray.size(), CHORDS_ID + std::to_string(PROGRESSION_ID) + "_" + std::to_string(ZONE_ID));//set selectedChord to "Custom"
-    GetChordFromChordString();
-    BuildChords();
+    {
+        // the chord and its "Custom" selection are set together
+        RibbonToNotesAudioProcessor::ScopedTransaction transaction(audioProcessor);
+        audioProcessor.UpdateParameter(chordbuildsArray.size(), GetParameterID(ParameterKind::chords, PROGRESSION_ID, ZONE_ID));//set selectedChord to "Custom"
+        GetChordFromChordString();
+    }
     cmbChord.setSelectedId(chordbuildsArray.size(), juce::sendNotificationSync);//set cmbChord to "Custom"
 }
 
@@ -167,8 +148,8 @@ void KeyZone::SetChordStringText()
     juce::String chordBuildStr;
     for(int j=0;j<MAX_NOTES;j++)
     {
-        chordBuildStr = chordBuildStr + std::to_string((int)*audioProcessor.chordNotes[PROGRESSION_ID][ZONE_ID][j]);
-        if(j+1==MAX_NOTES || (int)*audioProcessor.chordNotes[PROGRESSION_ID][ZONE_ID][j+1] == NONOTE)
+        chordBuildStr = chordBuildStr + std::to_string(audioProcessor.GetChordNote(PROGRESSION_ID, ZONE_ID, j));
+        if(j+1==MAX_NOTES || audioProcessor.GetChordNote(PROGRESSION_ID, ZONE_ID, j+1) == NONOTE)
         {
             break;
         }
@@ -184,27 +165,20 @@ void KeyZone::GetChordFromChordString()
 {
     juce::StringArray chordStringArray;
     chordStringArray.addTokens(edtChordBuilder.getText(),",","");
+    int intervals[MAX_NOTES];
     for(int j = 0;j < MAX_NOTES ; j++)
     {
         if(j<chordStringArray.size() && is_validnotenumber(chordStringArray[j]))
         {
-            auto value =chordStringArray[j].getIntValue();
-            SetChordParameter(j,value);
+            intervals[j] = chordStringArray[j].getIntValue();
         }
         else
         {
-            SetChordParameter(j,NONOTE);
+            intervals[j] = NONOTE;
         }
     }
-}
-
-void KeyZone::SetChordParameter(int j, float value)
-{
-    audioProcessor.UpdateParameter(value, CHORDBUILDS_ID + std::to_string(PROGRESSION_ID) + "_" + std::to_string(ZONE_ID) + "_" + std::to_string(j));
-}
-void KeyZone::SetNoteParameter(int j, float value)
-{
-    audioProcessor.UpdateParameter(value, NOTESTOPLAY_ID + std::to_string(PROGRESSION_ID) + "_" + std::to_string(ZONE_ID) + "_" + std::to_string(j));
+    RibbonToNotesAudioProcessor::ScopedTransaction transaction(audioProcessor);
+    audioProcessor.SetChordBuild(PROGRESSION_ID, ZONE_ID, intervals);
 }
 
 bool KeyZone::is_validnotenumber(const juce::String& str)
@@ -220,20 +194,9 @@ bool KeyZone::is_validnotenumber(const juce::String& str)
     }
     return isvalid;
 }
-void KeyZone::BuildChords()
-{
-    if(ribbonToNotesAudioProcessorEditor != NULL && BuildChordsFuncP != NULL)
-    {
-        BuildChordsFuncP(ribbonToNotesAudioProcessorEditor, PROGRESSION_ID);
-    }
-}
 int KeyZone::GetRelativeNoteNumber(int selectedzone, int notenumber)
 {
-    if(ribbonToNotesAudioProcessorEditor != NULL && GetRelativeNoteNumberP != NULL)
-    {
-        return GetRelativeNoteNumberP(ribbonToNotesAudioProcessorEditor, PROGRESSION_ID, selectedzone, notenumber);
-    }
-    return NONOTE;
+    return audioProcessor.GetRelativeNoteNumber(PROGRESSION_ID, selectedzone, notenumber);
 }
 int KeyZone::Transposed()
 {
@@ -290,10 +253,6 @@ bool KeyZone::midiLearnMessage(juce::MidiBuffer messagebuffer, int selectedzone)
 //==============================================================================
 // listeners
 //==============================================================================
-void KeyZone::sliderValueChanged(juce::Slider* slider)
-{
-}
-
 void KeyZone::comboBoxChanged(juce::ComboBox* combobox)
 {
     if(Service::PresetManager::PresetLoading !=  Service::ePresetLoading::notLoading) return;
@@ -302,7 +261,6 @@ void KeyZone::comboBoxChanged(juce::ComboBox* combobox)
     {
         prevKey = currentKey;
         currentKey = cmbKey.getSelectedId();
-        BuildChords();
         return;
     }
     if(combobox == &cmbChord)
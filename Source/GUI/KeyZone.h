@@ -15,7 +15,6 @@
 // Class for Key Zone, with settings for key, chord mode and chord build.
 //==============================================================================
 class KeyZone : public ZoneVisual,
-private juce::Slider::Listener,
 private juce::ComboBox::Listener 
 {
 public:
@@ -38,21 +37,14 @@ public:
     void EdtChordBuilderOnChange();
     void SetChordStringText();
     void GetChordFromChordString();
-    void SetChordParameter(int j, float value);
-    void SetNoteParameter(int j, float value);
     bool is_validnotenumber(const juce::String& str);
-    void BuildChords();
     int GetRelativeNoteNumber(int selectedkey, int notenumber);
-    void* ribbonToNotesAudioProcessorEditor;
-    void (*BuildChordsFuncP)(void*, int progression_id);
-    int (*GetRelativeNoteNumberP)(void*, int progression_id, int selectedzone, int notenumber);
 
     bool midiLearnMessage(juce::MidiBuffer messagebuffer, int selectedzone);
 
     //==============================================================================
     // listeners
     //==============================================================================
-    void sliderValueChanged(juce::Slider* slider) override;
     void comboBoxChanged(juce::ComboBox* combobox) override;
 
     
@@ -73,13 +65,10 @@ private:
     RibbonToNotesAudioProcessor& audioProcessor;
     
     bool edtChordChanged;
-    juce::Slider sldChordNotesHelp[MAX_NOTES];//this is not visible, but helps to save and load the chord notes to and from a preset.
     juce::Array<int> LearnedNotes;
     
 public:
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> cmbKeysAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> cmbChordsAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sldChordNotesHelpAttachment[MAX_NOTES];
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sldNotesToPlayHelpAttachment[MAX_NOTES];
 };
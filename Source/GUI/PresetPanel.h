@@ -11,19 +11,31 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../PluginProcessor.h"
 
 namespace GUI
 {
-    class PresetPanel : public juce::Component, juce::Button::Listener, juce::ComboBox::Listener
+    class PresetPanel : public juce::Component, juce::Button::Listener, juce::ComboBox::Listener, juce::Timer
     {
     public:
 
-PresetPanel(Service::PresetManager& pm):presetManager(pm)
+PresetPanel(RibbonToNotesAudioProcessor& p):processor(p), presetManager(p.getPresetManager())
         {
             configureButton(saveButton, "Save");
             configureButton(deleteButton, "Delete");
             configureButton(previousPresetButton, "<");
             configureButton(nextPresetButton, ">");
+            saveButton.setTooltip("Save the preset, right click for the preset bank and the midi delivery");
+            // right click on < or > learns the control that steps through the bank
+            previousPresetButton.setTooltip("Previous preset, right click to learn a control");
+            nextPresetButton.setTooltip("Next preset, right click to learn a control");
+
+            // program changes select the presets of the bank
+            bankButton.setButtonText("Bank");
+            bankButton.setTooltip("Program change n selects the n-th preset");
+            bankButton.setMouseCursor(juce::MouseCursor::PointingHandCursor);
+            addAndMakeVisible(bankButton);
+            bankButton.addListener(this);
             
             presetList.setTextWhenNothingSelected("No Preset Selected");
             presetList.setMouseCursor(juce::MouseCursor::PointingHandCursor);
@@ -31,14 +43,18 @@ PresetPanel(Service::PresetManager& pm):presetManager(pm)
             presetList.addListener(this);
             
             LoadPresetList();
+            timerCallback();
+            startTimerHz(10);
         }
         
         ~PresetPanel()
         {
+            stopTimer();
             saveButton.removeListener(this);
             deleteButton.removeListener(this);
             previousPresetButton.removeListener(this);
             nextPresetButton.removeListener(this);
+            bankButton.removeListener(this);
         }
         
         void resized() override
@@ -46,10 +62,11 @@ PresetPanel(Service::PresetManager& pm):presetManager(pm)
             const auto container = getLocalBounds().reduced(4);
             auto bounds = container;
             
-            saveButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.2f)).reduced(4));
+            saveButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.15f)).reduced(4));
             previousPresetButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.1f)).reduced(4));
-            presetList.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.4f)).reduced(4));
+            presetList.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.35f)).reduced(4));
             nextPresetButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.1f)).reduced(4));
+            bankButton.setBounds(bounds.removeFromLeft(container.proportionOfWidth(0.15f)).reduced(4));
             deleteButton.setBounds(bounds.reduced(4));
         }
         
@@ -57,6 +74,11 @@ PresetPanel(Service::PresetManager& pm):presetManager(pm)
     private:
         void buttonClicked(juce::Button* button) override
         {
+            if(button == &saveButton && juce::ModifierKeys::getCurrentModifiers().isPopupMenu())
+            {
+                ShowSettingsMenu();
+                return;
+            }
             if(button ==  &saveButton)
             {
                 fileChooser = std::make_unique<juce::FileChooser>
@@ -72,6 +94,19 @@ PresetPanel(Service::PresetManager& pm):presetManager(pm)
                     LoadPresetList();
                 });
             }
+            if((button == &previousPresetButton || button == &nextPresetButton)
+               && juce::ModifierKeys::getCurrentModifiers().isPopupMenu())
+            {
+                processor.LearnPresetControl(button == &nextPresetButton);
+                button->setButtonText("learn");
+                return;
+            }
+            if(button == &bankButton)
+            {
+                auto settings = processor.GetPresetBankSettings();
+                settings.enabled = bankButton.getToggleState();
+                processor.SetPresetBankSettings(settings);
+            }
             if(button == &previousPresetButton)
             {
                 const auto index = presetManager.loadPreviousPreset();
@@ -97,6 +132,102 @@ PresetPanel(Service::PresetManager& pm):presetManager(pm)
             }
         }
         
+        // all presets in one file (Engine/PresetBankFile.h), and how the notes are handed to the host
+        void ShowSettingsMenu()
+        {
+            juce::PopupMenu menu;
+            menu.addItem("Export preset bank...", [this]
+            {
+                fileChooser = std::make_unique<juce::FileChooser>("Export the presets to a bank", Service::PresetManager::defaultDirectory,
+                                                                  "*." + Service::PresetManager::bankExtension);
+                fileChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::warnAboutOverwriting,
+                                         [this](const juce::FileChooser& chooser)
+                {
+                    const auto resultFile = chooser.getResult();
+                    if(resultFile != juce::File())
+                        presetManager.exportBank(resultFile.withFileExtension(Service::PresetManager::bankExtension));
+                });
+            });
+            menu.addItem("Import preset bank...", [this]
+            {
+                fileChooser = std::make_unique<juce::FileChooser>("Import the presets of a bank", juce::File(),
+                                                                  "*." + Service::PresetManager::bankExtension);
+                fileChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                         [this](const juce::FileChooser& chooser)
+                {
+                    const auto resultFile = chooser.getResult();
+                    if(resultFile.existsAsFile())
+                        presetManager.importBank(resultFile);
+                });
+            });
+            menu.addSeparator();
+            menu.addSubMenu("Midi delivery", CreateDeliveryMenu());
+            menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&saveButton));
+        }
+
+        // the delivery policy (Engine/DeliveryScheduler.h), for hosts that do not take every note of a chord in one block
+        juce::PopupMenu CreateDeliveryMenu()
+        {
+            const auto policy = processor.GetDeliveryPolicy();
+            auto setPolicy = [this](DeliveryMode mode, int eventsPerBlock, int spreadSamples)
+            {
+                auto newPolicy = processor.GetDeliveryPolicy();
+                newPolicy.mode = mode;
+                newPolicy.eventsPerBlock = eventsPerBlock;
+                newPolicy.spreadSamples = spreadSamples;
+                processor.SetDeliveryPolicy(newPolicy);
+            };
+
+            juce::PopupMenu menu;
+            menu.addItem("All at once", true, policy.mode == DeliveryMode::allAtOnce, [=]
+            {
+                setPolicy(DeliveryMode::allAtOnce, policy.eventsPerBlock, policy.spreadSamples);
+            });
+            juce::PopupMenu eventsMenu;
+            for(int events : {1, 2, 4, 8})
+            {
+                eventsMenu.addItem(juce::String(events), true, policy.mode == DeliveryMode::eventsPerBlock && policy.eventsPerBlock == events, [=]
+                {
+                    setPolicy(DeliveryMode::eventsPerBlock, events, policy.spreadSamples);
+                });
+            }
+            AddTickedSubMenu(menu, "Events per block", eventsMenu, policy.mode == DeliveryMode::eventsPerBlock);
+            juce::PopupMenu spreadMenu;
+            for(int samples : {32, 64, 128, 256})
+            {
+                spreadMenu.addItem(juce::String(samples), true, policy.mode == DeliveryMode::spreadOverSamples && policy.spreadSamples == samples, [=]
+                {
+                    setPolicy(DeliveryMode::spreadOverSamples, policy.eventsPerBlock, samples);
+                });
+            }
+            AddTickedSubMenu(menu, "Spread over samples", spreadMenu, policy.mode == DeliveryMode::spreadOverSamples);
+            menu.addSeparator();
+            // Patchwork only needs the limit for small blocks, a large block would delay the chord too much
+            menu.addItem("Only limit blocks up to 256 samples", policy.mode == DeliveryMode::eventsPerBlock, policy.maxBlockSize > 0, [this, policy]
+            {
+                auto newPolicy = policy;
+                newPolicy.maxBlockSize = policy.maxBlockSize > 0 ? 0 : 256;
+                processor.SetDeliveryPolicy(newPolicy);
+            });
+            menu.addItem("Default of the host", [this]
+            {
+                processor.SetDeliveryPolicy(RibbonToNotesAudioProcessor::GetDefaultDeliveryPolicy());
+            });
+            const auto sampleRate = processor.getSampleRate() > 0 ? processor.getSampleRate() : 48000.0;
+            menu.addSeparator();
+            menu.addItem("Notes of a chord are late by up to " + juce::String(1000.0 * processor.getDeliveryLatency() / sampleRate, 1) + " ms",
+                         false, false, nullptr);
+            return menu;
+        }
+
+        static void AddTickedSubMenu(juce::PopupMenu& menu, const juce::String& name, juce::PopupMenu subMenu, bool isTicked)
+        {
+            juce::PopupMenu::Item item(name);
+            item.subMenu = std::make_unique<juce::PopupMenu>(std::move(subMenu));
+            item.setTicked(isTicked);
+            menu.addItem(std::move(item));
+        }
+
         void configureButton(juce::Button& button, const juce::String& buttontext)
         {
             button.setButtonText(buttontext);
@@ -108,15 +239,42 @@ PresetPanel(Service::PresetManager& pm):presetManager(pm)
         void LoadPresetList() 
         {
             presetList.clear(juce::dontSendNotification);
+            presetListVersion = presetManager.getPresetListVersion();
             const auto allPresets = presetManager.getAllPresets();
             const auto currentPreset = presetManager.getCurrentPreset();
             presetList.addItemList(allPresets, 1);
             presetList.setSelectedItemIndex(allPresets.indexOf(currentPreset), juce::dontSendNotification);
         }
 
+        // the bank can also be changed by the host (state), by program changes and by the learned controls.
+        // The list of presets changes when files are added or removed, also by other programs.
+        void timerCallback() override
+        {
+            if(presetManager.getPresetListVersion() != presetListVersion)
+                LoadPresetList();
+            bankButton.setToggleState(processor.GetPresetBankSettings().enabled, juce::dontSendNotification);
+            const auto currentPreset = presetManager.getCurrentPreset();
+            if(presetList.getText() != currentPreset)
+            {
+                for(int i=0;i<presetList.getNumItems();i++)
+                {
+                    if(presetList.getItemText(i) == currentPreset)
+                        presetList.setSelectedItemIndex(i, juce::dontSendNotification);
+                }
+            }
+            if(! processor.IsLearningPresetControl())
+            {
+                previousPresetButton.setButtonText("<");
+                nextPresetButton.setButtonText(">");
+            }
+        }
+
         juce::TextButton saveButton, deleteButton, previousPresetButton, nextPresetButton;
+        juce::ToggleButton bankButton;
         juce::ComboBox presetList;
+        RibbonToNotesAudioProcessor& processor;
         Service::PresetManager& presetManager;
+        int presetListVersion = 0;
         std::unique_ptr<juce::FileChooser> fileChooser;
         
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetPanel)
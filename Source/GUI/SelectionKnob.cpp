@@ -33,15 +33,15 @@ void SelectionKnob::CreateGui()
     
     setButtonText(progressionKnobs[PROGRESSION_ID]);
     
-    cmbMidiMessageAttachment= std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, DEFCONCAT(MIDIINMESSAGETYPE_ID, PROGRESSION) + std::to_string(PROGRESSION_ID) , cmbMidiInMessage);
+    cmbMidiMessageAttachment= std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, GetParameterID(ParameterKind::midiInMessageTypeProgression, PROGRESSION_ID), cmbMidiInMessage);
 
-    cmbMidiInChannelAttachment= std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, DEFCONCAT(MIDIINCHANNEL_ID, PROGRESSION) + std::to_string(PROGRESSION_ID) , cmbMidiInChannel);
+    cmbMidiInChannelAttachment= std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, GetParameterID(ParameterKind::midiInChannelProgression, PROGRESSION_ID), cmbMidiInChannel);
 
-    cmbMidiInNumberAttachment= std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, DEFCONCAT(MIDIINNUMBER_ID, PROGRESSION) + std::to_string(PROGRESSION_ID) , cmbMidiInNumber);
+    cmbMidiInNumberAttachment= std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.apvts, GetParameterID(ParameterKind::midiInNumberProgression, PROGRESSION_ID), cmbMidiInNumber);
 
-    sldMidiInMinValueAttachment= std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, DEFCONCAT(MIDIINMINVALUE_ID, PROGRESSION) + std::to_string(PROGRESSION_ID) , sldMidiInMinValue);
+    sldMidiInMinValueAttachment= std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, GetParameterID(ParameterKind::midiInMinValueProgression, PROGRESSION_ID), sldMidiInMinValue);
 
-    sldMidiInMaxValueAttachment= std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, DEFCONCAT(MIDIINMAXVALUE_ID, PROGRESSION) + std::to_string(PROGRESSION_ID) , sldMidiInMaxValue);
+    sldMidiInMaxValueAttachment= std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, GetParameterID(ParameterKind::midiInMaxValueProgression, PROGRESSION_ID), sldMidiInMaxValue);
 }
 void SelectionKnob::AddListeners()
 {
@@ -14,8 +14,10 @@
 RibbonToNotesAudioProcessorEditor::RibbonToNotesAudioProcessorEditor ( RibbonToNotesAudioProcessor& p)
 : AudioProcessorEditor (&p)
 , audioProcessor (p)
-, presetPanel(p.getPresetManager())
+, presetPanel(p)
 , sldVelocity(p, VELOCITY_ID)
+, sldTranspose(p, TRANSPOSE_ID)
+, sldOctaveShift(p, OCTAVESHIFT_ID)
 , ribbonZeroZone(0,0)
 , prevProgression(audioProcessor, MAX_PROGRESSIONS)
 , nextProgression(audioProcessor, MAX_PROGRESSIONS+1)
@@ -44,6 +46,8 @@ RibbonToNotesAudioProcessorEditor::~RibbonToNotesAudioProcessorEditor()
     sldNumberOfZonesAttachment = nullptr;
     sldVelocityAttachment = nullptr;
     sldOctaveAttachment = nullptr;
+    sldTransposeAttachment = nullptr;
+    sldOctaveShiftAttachment = nullptr;
     cmbChannelInAttachment = nullptr;
     cmbChannelOutAttachment = nullptr;
     cmbPitchModesAttachment = nullptr;
@@ -68,9 +72,6 @@ void RibbonToNotesAudioProcessorEditor::CreateRibbon()
         for(int zone=0;zone<MAX_ZONES;zone++)
         {
             ribbonKeyZone[alt].add(new KeyZone(audioProcessor, alt, zone));
-            ribbonKeyZone[alt][zone]->ribbonToNotesAudioProcessorEditor = this;
-            ribbonKeyZone[alt][zone]->BuildChordsFuncP = BuildChordsWrapper;
-            ribbonKeyZone[alt][zone]->GetRelativeNoteNumberP = GetRelativeNoteNumberWrapper;
         }
     }
 }
@@ -120,6 +121,19 @@ void RibbonToNotesAudioProcessorEditor::CreateGui()
     lblOctave.attachToComponent(&sldOctave, false);
     lblOctave.setJustificationType(juce::Justification::centred);
 
+    // transpose and octave shift are added when the notes are played, the keys stay as they are
+    CreateDial(sldTranspose);
+    sldTransposeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, TRANSPOSE_ID, sldTranspose);
+    lblTranspose.setText("Transpose", juce::dontSendNotification);
+    lblTranspose.attachToComponent(&sldTranspose, false);
+    lblTranspose.setJustificationType(juce::Justification::centred);
+
+    CreateDial(sldOctaveShift);
+    sldOctaveShiftAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, OCTAVESHIFT_ID, sldOctaveShift);
+    lblOctaveShift.setText("Oct shift", juce::dontSendNotification);
+    lblOctaveShift.attachToComponent(&sldOctaveShift, false);
+    lblOctaveShift.setJustificationType(juce::Justification::centred);
+
     addAndMakeVisible(toggleShowMidiLearnSettings);
     lblShowMidiLearnSettings.setText(TOGGLEMIDI_NAME, juce::dontSendNotification);
     lblShowMidiLearnSettings.attachToComponent(&toggleShowMidiLearnSettings, true);
@@ -187,7 +201,7 @@ void RibbonToNotesAudioProcessorEditor::CreateGui()
     for(int i=0;i<MAX_SPLITS;i++)
     {
         CreateSlider(sldSplitValues[i]);
-        sldSplitValuesAttachment[i] = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, SPLITS_ID + std::to_string(i), sldSplitValues[i]);
+        sldSplitValuesAttachment[i] = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.apvts, GetParameterID(ParameterKind::splits, i), sldSplitValues[i]);
         addAndMakeVisible(lblSplitValues[i]);
     }
 }
@@ -218,6 +232,10 @@ void RibbonToNotesAudioProcessorEditor::AddListeners()
     sldVelocity.addListener(this);
     midiLearnGroup.Add(&sldVelocity);
     sldOctave.addListener(this);
+    sldTranspose.addListener(this);
+    midiLearnGroup.Add(&sldTranspose);
+    sldOctaveShift.addListener(this);
+    midiLearnGroup.Add(&sldOctaveShift);
 
     toggleShowMidiLearnSettings.addListener(this);
     toggleMidiLearn.addListener(this);
@@ -263,6 +281,8 @@ void RibbonToNotesAudioProcessorEditor::RemoveListeners()
     sldNumberOfZones.removeListener (this);
     sldVelocity.removeListener(this);
     sldOctave.removeListener(this);
+    sldTranspose.removeListener(this);
+    sldOctaveShift.removeListener(this);
     
     toggleShowMidiLearnSettings.removeListener(this);
     toggleMidiLearn.removeListener(this);
@@ -358,6 +378,14 @@ void RibbonToNotesAudioProcessorEditor::resized()
     col++;
     sldOctave.setBounds(sideMargin + col*(sideMargin + controlWidth), topGeneralControls, controlWidth, dialHeight);
     sldOctave.setTextBoxStyle(juce::Slider::TextBoxBelow, false, controlWidth, textHeight);
+
+    col++;
+    sldTranspose.setBounds(sideMargin + col*(sideMargin + controlWidth), topGeneralControls, controlWidth, dialHeight);
+    sldTranspose.setTextBoxStyle(juce::Slider::TextBoxBelow, false, controlWidth, textHeight);
+
+    col++;
+    sldOctaveShift.setBounds(sideMargin + col*(sideMargin + controlWidth), topGeneralControls, controlWidth, dialHeight);
+    sldOctaveShift.setTextBoxStyle(juce::Slider::TextBoxBelow, false, controlWidth, textHeight);
     
     
     int row = 0;
@@ -432,6 +460,8 @@ void RibbonToNotesAudioProcessorEditor::SyncKeyAndChordModes(int progression, in
         int transpose = key - rootKey[progression];
         rootKey[progression] = key;
         
+        // the keys are set together when the transaction goes out of scope
+        RibbonToNotesAudioProcessor::ScopedTransaction transaction(audioProcessor);
         // get the selected key and chord mode for each zone
         for(int z=0 ; z < MAX_ZONES; z++)
         {
@@ -446,12 +476,10 @@ void RibbonToNotesAudioProcessorEditor::SyncKeyAndChordModes(int progression, in
             }
             
             // set the selected key
-            audioProcessor.UpdateParameter(key, KEYS_ID + std::to_string(progression) + "_" + std::to_string(z));
+            audioProcessor.UpdateParameter(key, GetParameterID(ParameterKind::keys, progression, z));
         }
     }
-    
-    // rebuild the chord for each zone based on key en chord mode setting
-    BuildChords(progression);
+    // the processor rebuilds the chord for each zone based on key en chord mode setting
 }
 void RibbonToNotesAudioProcessorEditor::TransposeKeyAndChordModes(int progression, int transpose)
 {
@@ -460,6 +488,8 @@ void RibbonToNotesAudioProcessorEditor::TransposeKeyAndChordModes(int progressio
         int key = ribbonKeyZone[progression][0]->cmbKey.getSelectedId();
         rootKey[progression] = key;
         
+        // the keys are set together when the transaction goes out of scope
+        RibbonToNotesAudioProcessor::ScopedTransaction transaction(audioProcessor);
         // get the selected key and chord mode for each zone
         for(int z=1 ; z < MAX_ZONES; z++)
         {
@@ -474,11 +504,9 @@ void RibbonToNotesAudioProcessorEditor::TransposeKeyAndChordModes(int progressio
             }
             
             // set the selected key
-            audioProcessor.UpdateParameter(key, KEYS_ID + std::to_string(progression) + "_" + std::to_string(z));
+            audioProcessor.UpdateParameter(key, GetParameterID(ParameterKind::keys, progression, z));
         }
-    
-    // rebuild the chord for each zone based on key en chord mode setting
-    BuildChords(progression);
+    // the processor rebuilds the chord for each zone based on key en chord mode setting
 }
 //==============================================================================
 // This functions shows the proper amount of key zones based on the selected
@@ -507,6 +535,8 @@ void RibbonToNotesAudioProcessorEditor::RedistributeSplitRanges(bool initSplitVa
     int max = zones == 1 ? 128 : fmin(value + 0.25 * stepSize,128);
     sldSplitValues[0].setRange(min, max);
 
+    // the split values are set together at the end. The final range of every slider contains its new value.
+    audioProcessor.beginTransaction();
     int i=1;
     int prevValue = 0;
     for(;i < MAX_ZONES;i++)
@@ -523,10 +553,11 @@ void RibbonToNotesAudioProcessorEditor::RedistributeSplitRanges(bool initSplitVa
         int max = i < lastSplit ? fmin(fmax(value + 0.25 * stepSize, value + 1),128) : 128;
         splitValuesSetFromCode = true;
         sldSplitValues[i].setRange(0, 128, 1);
-        audioProcessor.UpdateParameter(value, SPLITS_ID + std::to_string(i));
+        audioProcessor.UpdateParameter(value, GetParameterID(ParameterKind::splits, i));
         prevValue = value;
         sldSplitValues[i].setRange(min, max, 1);
     }
+    audioProcessor.commitTransaction();
     splitValuesSetFromCode = false;
 }
 //==============================================================================
@@ -555,7 +586,7 @@ void RibbonToNotesAudioProcessorEditor::sliderDragEnded(juce::Slider* slider)
     }
     if(slider == &sldOctave)
     {
-        BuildChordsForAllProgressions();
+        // the processor rebuilds the chords
         return;
     }
         // check if number of zones has changed. If so, update the GUI.
@@ -575,7 +606,7 @@ void RibbonToNotesAudioProcessorEditor::comboBoxChanged(juce::ComboBox* combobox
     if(Service::PresetManager::PresetLoading ==  true) return;
     if(combobox == &cmbPitchModes)
     {
-        BuildChordsForAllProgressions();
+        // the processor rebuilds the chords
         return;
     }
     if(combobox == &cmbActiveProgression)
@@ -677,104 +708,6 @@ void RibbonToNotesAudioProcessorEditor::buttonClicked(juce::Button* button)
     
 }
 
-//==============================================================================
-// build notes to play
-//==============================================================================
-void RibbonToNotesAudioProcessorEditor::BuildChordsForAllProgressions()
-{
-    for(int prog=0;prog<MAX_PROGRESSIONS;prog++)
-    {
-        BuildChords(prog);
-    }
-}
-
-void RibbonToNotesAudioProcessorEditor::BuildChords(int progression)
-{
-    int maxNote = 0;
-    int key = 0;
-    int octave = (int) *audioProcessor.octaves;
-    int addOctaves=0;
-    int pitchMode = (int) *audioProcessor.pitchMode;
-    
-    for(int zone=0 ; zone < MAX_ZONES; zone++)
-    {
-        key = (int) *audioProcessor.selectedKeys[progression][zone];
-        
-        //pitchMode 0 = up
-        if(pitchMode == 0)
-        {
-            //if the notevalue is lower then the highest note, just add an octave to it.
-            if(key <= maxNote && (key + ( octave + addOctaves + 1) * 12) < 128)
-            {
-                addOctaves++;
-            }
-            maxNote = key;
-        }
-        GetNoteNumbersForChord(octave + addOctaves, progression, zone, key);
-    }
-}
-int RibbonToNotesAudioProcessorEditor::GetRelativeNoteNumber(int progression, int selectedzone, int notenumber)
-{
-    int maxNote = 0;
-    int key = 0;
-    int octave = (int) *audioProcessor.octaves;
-    int addOctaves=0;
-
-    //pitchMode 0 = up
-    key = (int) *audioProcessor.selectedKeys[progression][selectedzone];
-        
-    //pitchMode 0 = up
-    for(int zone=0 ; zone < MAX_ZONES; zone++)
-    {
-        key = (int) *audioProcessor.selectedKeys[progression][zone];
-        
-        //pitchMode 0 = up
-        if(*audioProcessor.pitchMode == 0)
-        {
-            //if the notevalue is lower then the highest note, just add an octave to it.
-            if(key <= maxNote && (key + ( octave + addOctaves + 1) * 12) < 128)
-            {
-                addOctaves++;
-            }
-            maxNote = key;
-        }
-        if(zone == selectedzone)
-        {
-            break;
-        }
-    }
-    int keynote = key + 24 - 1 + (octave + addOctaves) * 12;; //Since addoctaves starts at -2, offset for key is -24. Also there is an offset of +1, because C corresponds to 1 in the list instead of 0. Both are corrected here.
-    int notediff = notenumber - keynote;
-    if(notediff > -128 && notediff < 128)
-    {
-        return notediff;
-    }
-    else
-    {
-        return NONOTE;
-    }
-}
-
-// calculate the notes to be played for a specific zone
-// since key equals to one instead of zero, the counting is a bit strange
-void RibbonToNotesAudioProcessorEditor::GetNoteNumbersForChord(int addOctaves, int progression, int zone, int key)
-{
-    for(int note=0;note<MAX_NOTES;note++)
-    {
-        int notenr = (int) *audioProcessor.chordNotes[progression][zone][note];
-        if(notenr != NONOTE)
-        {
-            int keynote = key + 24 - 1; //Since addoctaves starts at -2, offset for key is -24. Also there is an offset of +1, because C corresponds to 1 in the list instead of 0. Both are corrected here.
-            if(keynote + notenr > 8 && addOctaves > 7) addOctaves = 7; //do not go past G8
-            notenr = keynote + notenr + addOctaves * 12;
-        }
-        auto notevalue = notenr == NONOTE ? 0 : notenr;
-        if(notevalue != *audioProcessor.notesToPlay[progression][zone][note])
-        {
-            audioProcessor.UpdateParameter(notevalue, NOTESTOPLAY_ID + std::to_string(progression) + "_" + std::to_string(zone) + "_" + std::to_string(note));
-        }
-     }
-}
 //==============================================================================
 // Update functions for the visuals
 //==============================================================================
@@ -853,6 +786,7 @@ void RibbonToNotesAudioProcessorEditor::UpdateMidiLearnControls()
 {
     sldVelocity.setValue(*audioProcessor.noteVelocity, juce::dontSendNotification);
     sldVelocity.repaint();
+    audioProcessor.ReadMidiLearnMessages();
     if(MidiLearnInterface::MidiLearnOn)
     {
         if(MidiLearnInterface::MidiSettingOn)
@@ -65,30 +65,6 @@ private:
     void comboBoxChanged(juce::ComboBox* combobox) override;
     void buttonClicked(juce::Button* button) override;
     
-    //==============================================================================
-    // build notes to play
-    //==============================================================================
-    void BuildChordsForAllProgressions();
-public:
-    void BuildChords(int alternative);
-    int GetRelativeNoteNumber(int progression, int selectedzone, int notenumber);
-    static void BuildChordsWrapper(void* audioProcessorEditor, int progression)
-    {
-        if(audioProcessorEditor != NULL)
-        {
-            static_cast<RibbonToNotesAudioProcessorEditor*>(audioProcessorEditor)->BuildChords(progression);
-        }
-    }
-    static int GetRelativeNoteNumberWrapper(void* audioProcessorEditor, int progression, int selectedzone, int notenumber)
-    {
-        if(audioProcessorEditor != NULL)
-        {
-            return static_cast<RibbonToNotesAudioProcessorEditor*>(audioProcessorEditor)->GetRelativeNoteNumber(progression, selectedzone, notenumber);
-        }
-        return NONOTE;
-    }
-private:
-    void GetNoteNumbersForChord(int addOctaves, int progression, int zone, int note);
     //==============================================================================
     // Update functions for the visuals
     //==============================================================================
@@ -113,6 +89,10 @@ private:
     juce::Label lblVelocity;
     juce::Slider sldOctave;
     juce::Label lblOctave;
+    SliderMidiLearn sldTranspose;
+    juce::Label lblTranspose;
+    SliderMidiLearn sldOctaveShift;
+    juce::Label lblOctaveShift;
 
     juce::ToggleButton toggleShowMidiLearnSettings;
     juce::Label lblShowMidiLearnSettings;
@@ -149,6 +129,8 @@ public:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sldNumberOfZonesAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sldVelocityAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sldOctaveAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sldTransposeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sldOctaveShiftAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> cmbChannelInAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> cmbChannelOutAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> cmbKeysAttachment[MAX_ZONES];
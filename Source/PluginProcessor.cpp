@@ -8,11 +8,11 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
-#include <Carbon/Carbon.h>
 
 //==============================================================================
 juce::AudioProcessorValueTreeState::ParameterLayout CreateParameterLayout()
 {
+    RIBBON_STARTUP_TIMER(parameterLayout);
     //juce::AudioProcessorValueTreeState::ParameterLayout params;
     
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
@@ -23,26 +23,50 @@ juce::AudioProcessorValueTreeState::ParameterLayout CreateParameterLayout()
                                                                MIDICC_NAME,
                                                                1,
                                                                128,
-                                                               22));
+                                                               DEFAULT_MIDICC));
     
     params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{NUMBEROFZONES_ID,versionHint1},
                                                                NUMBEROFZONES_NAME,
                                                                1,
                                                                MAX_ZONES,
-                                                               6));
+                                                               DEFAULT_NUMBEROFZONES));
     
     params.push_back(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{VELOCITY_ID,versionHint1},
                                                                  VELOCITY_NAME,
                                                                  0.0f,
                                                                  1.0f,
-                                                                 90.0/127.0));
-    int defaultOctave = 2;
+                                                                 DEFAULT_VELOCITY));
+    int defaultOctave = DEFAULT_OCTAVE;
     params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{OCTAVES_ID,versionHint1},
                                                                OCTAVES_NAME,
                                                                -2,
                                                                8,
                                                                defaultOctave));
 
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{HYSTERESIS_ID,versionHint1},
+                                                               HYSTERESIS_NAME,
+                                                               0,
+                                                               16,
+                                                               0));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{MINIMUMDWELL_ID,versionHint1},
+                                                               MINIMUMDWELL_NAME,
+                                                               0,
+                                                               250,
+                                                               0));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{LEGATO_ID,versionHint1},
+                                                               LEGATO_NAME,
+                                                               0,
+                                                               1,
+                                                               0));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{NOTEOFFSTYLE_ID,versionHint1},
+                                                               NOTEOFFSTYLE_NAME,
+                                                               0,
+                                                               2,
+                                                               0));
+
     params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{CHANNELIN_ID,versionHint1},
                                                                CHANNELIN_NAME,
                                                                0,
@@ -66,6 +90,18 @@ juce::AudioProcessorValueTreeState::ParameterLayout CreateParameterLayout()
                                                                0,
                                                                7,
                                                                0));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{TRANSPOSE_ID,versionHint1},
+                                                               TRANSPOSE_NAME,
+                                                               -MAX_TRANSPOSE,
+                                                               MAX_TRANSPOSE,
+                                                               0));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{OCTAVESHIFT_ID,versionHint1},
+                                                               OCTAVESHIFT_NAME,
+                                                               -MAX_OCTAVESHIFT,
+                                                               MAX_OCTAVESHIFT,
+                                                               0));
     int stepSize = 127/DEFAULT_NUMBEROFZONES;
     bool enabled = true;
 
@@ -77,38 +113,16 @@ juce::AudioProcessorValueTreeState::ParameterLayout CreateParameterLayout()
             {
                 if(i<MAX_ZONES)
                 {
-                    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{KEYS_ID + std::to_string(prog) + "_" + std::to_string(i),versionHint1},
+                    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{GetParameterID(ParameterKind::keys, prog, i),versionHint1},
                                                                                KEYS_NAME,
                                                                                1,
                                                                                12,
                                                                                defaultNoteOrder[i]));
-                    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{CHORDS_ID + std::to_string(prog) + "_" + std::to_string(i),versionHint1},
+                    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{GetParameterID(ParameterKind::chords, prog, i),versionHint1},
                                                                                CHORDS_NAME,
                                                                                1,
                                                                                chordsArray.size(),
                                                                                1));
-                    int chordBuildDefault = 0;//default only base note
-                    int noteDefault = defaultNoteOrder[i] + 24 -1 + defaultOctave * 12;
-
-                    for(int j=0;j<MAX_NOTES;j++)
-                    {
-                        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{CHORDBUILDS_ID + std::to_string(prog) + "_" + std::to_string(i) + "_" + std::to_string(j),versionHint1},
-                                                                                   CHORDBUILDS_NAME,
-                                                                                   -128,
-                                                                                   1278,
-                                                                                   chordBuildDefault));
-                        chordBuildDefault = NONOTE;//default only the base note
-                        
-                        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{NOTESTOPLAY_ID 
-                            + std::to_string(prog) + "_"
-                            + std::to_string(i) + "_"
-                            + std::to_string(j), versionHint1},
-                                                                                   NOTESTOPLAY_NAME,
-                                                                                   0,
-                                                                                   128,
-                                                                                   noteDefault));
-                        noteDefault = 0;//default no chords
-                    }
                 }
                 if(i >= DEFAULT_NUMBEROFZONES)
                 {
@@ -118,7 +132,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout CreateParameterLayout()
                 if(i>=DEFAULT_NUMBEROFZONES) defaultsplit = 128;
                 if(prog == 0)
                 {
-                    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{SPLITS_ID + std::to_string(i),versionHint1},
+                    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{GetParameterID(ParameterKind::splits, i),versionHint1},
                                                                                SPLITS_NAME,
                                                                                0,
                                                                                128,
@@ -126,31 +140,31 @@ juce::AudioProcessorValueTreeState::ParameterLayout CreateParameterLayout()
                 }
             }
         }
-        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINMESSAGETYPE_ID, PROGRESSION) + std::to_string(prog),versionHint1},
+        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{GetParameterID(ParameterKind::midiInMessageTypeProgression, prog),versionHint1},
                                                                    MIDIINMESSAGETYPE_NAME,
                                                                    0,
                                                                    2,
                                                                    2));
 
-        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINCHANNEL_ID, PROGRESSION) + std::to_string(prog),versionHint1},
+        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{GetParameterID(ParameterKind::midiInChannelProgression, prog),versionHint1},
                                                                    MIDIINCHANNEL_NAME,
                                                                    0,
                                                                    16,
                                                                    0));
 
-        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINNUMBER_ID, PROGRESSION) + std::to_string(prog),versionHint1},
+        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{GetParameterID(ParameterKind::midiInNumberProgression, prog),versionHint1},
                                                                    MIDIINNUMBER_NAME,
                                                                    0,
                                                                    127,
                                                                    24+prog));
 
-        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINMINVALUE_ID, PROGRESSION) + std::to_string(prog),versionHint1},
+        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{GetParameterID(ParameterKind::midiInMinValueProgression, prog),versionHint1},
                                                                    MIDIINMINVALUE_NAME,
                                                                    0,
                                                                    127,
                                                                    1));
 
-        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINMAXVALUE_ID, PROGRESSION) + std::to_string(prog),versionHint1},
+        params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{GetParameterID(ParameterKind::midiInMaxValueProgression, prog),versionHint1},
                                                                    MIDIINMAXVALUE_NAME,
                                                                    0,
                                                                    127,
@@ -184,6 +198,64 @@ juce::AudioProcessorValueTreeState::ParameterLayout CreateParameterLayout()
                                                                0,
                                                                127,
                                                                127));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINMESSAGETYPE_ID, TRANSPOSE_ID),versionHint1},
+                                                               MIDIINMESSAGETYPE_NAME,
+                                                               0,
+                                                               2,
+                                                               0));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINCHANNEL_ID, TRANSPOSE_ID),versionHint1},
+                                                               MIDIINCHANNEL_NAME,
+                                                               0,
+                                                               16,
+                                                               0));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINNUMBER_ID, TRANSPOSE_ID),versionHint1},
+                                                               MIDIINNUMBER_NAME,
+                                                               0,
+                                                               127,
+                                                               14));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINMINVALUE_ID, TRANSPOSE_ID),versionHint1},
+                                                               MIDIINMINVALUE_NAME,
+                                                               0,
+                                                               127,
+                                                               0));
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINMAXVALUE_ID, TRANSPOSE_ID),versionHint1},
+                                                               MIDIINMAXVALUE_NAME,
+                                                               0,
+                                                               127,
+                                                               127));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINMESSAGETYPE_ID, OCTAVESHIFT_ID),versionHint1},
+                                                               MIDIINMESSAGETYPE_NAME,
+                                                               0,
+                                                               2,
+                                                               0));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINCHANNEL_ID, OCTAVESHIFT_ID),versionHint1},
+                                                               MIDIINCHANNEL_NAME,
+                                                               0,
+                                                               16,
+                                                               0));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINNUMBER_ID, OCTAVESHIFT_ID),versionHint1},
+                                                               MIDIINNUMBER_NAME,
+                                                               0,
+                                                               127,
+                                                               15));
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINMINVALUE_ID, OCTAVESHIFT_ID),versionHint1},
+                                                               MIDIINMINVALUE_NAME,
+                                                               0,
+                                                               127,
+                                                               0));
+    params.push_back(std::make_unique<juce::AudioParameterInt>(juce::ParameterID{DEFCONCAT(MIDIINMAXVALUE_ID, OCTAVESHIFT_ID),versionHint1},
+                                                               MIDIINMAXVALUE_NAME,
+                                                               0,
+                                                               127,
+                                                               127));
     return {params.begin(), params.end()};
 }
 //==============================================================================
@@ -204,22 +276,45 @@ RibbonToNotesAudioProcessor::RibbonToNotesAudioProcessor()
     apvts.state.setProperty(Service::PresetManager::presetNameProperty, "", nullptr);
     apvts.state.setProperty("version", ProjectInfo::versionString, nullptr);
     
-    midiCC = apvts.getRawParameterValue(MIDICC_ID);
-    numberOfZones = apvts.getRawParameterValue(NUMBEROFZONES_ID);
-    noteVelocity = apvts.getRawParameterValue(VELOCITY_ID);
-    octaves = apvts.getRawParameterValue(OCTAVES_ID);
-    channelIn = apvts.getRawParameterValue(CHANNELIN_ID);
-    channelOut = apvts.getRawParameterValue(CHANNELOUT_ID);
-    pitchMode = apvts.getRawParameterValue(PITCHMODES_ID);
-    activeProgression = apvts.getRawParameterValue(ACTIVEPROGRESSION_ID);
+    // the binary state finds the parameters by the hash of their id. This is the only lookup of the
+    // parameters by their id string, the members below are bound by the hash
+    stateParameters.reserve((std::size_t) getParameters().size());
+    for(auto* parameter : getParameters())
+    {
+        if(auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+        {
+            stateParameters.push_back({BinaryState::HashID(ranged->paramID.toRawUTF8()), ranged, apvts.getRawParameterValue(ranged->paramID)});
+            ranged->addListener(this);
+        }
+    }
+    apvts.state.addListener(this);
+    std::sort(stateParameters.begin(), stateParameters.end(),
+              [](const StateParameter& first, const StateParameter& second) { return first.idHash < second.idHash; });
+    // two parameter ids with the same hash can not be told apart in a saved state
+    jassert(std::adjacent_find(stateParameters.begin(), stateParameters.end(),
+                               [](const StateParameter& first, const StateParameter& second) { return first.idHash == second.idHash; }) == stateParameters.end());
+
+    midiCC = GetRawValue(MIDICC_ID);
+    numberOfZones = GetRawValue(NUMBEROFZONES_ID);
+    noteVelocity = GetRawValue(VELOCITY_ID);
+    octaves = GetRawValue(OCTAVES_ID);
+    hysteresis = GetRawValue(HYSTERESIS_ID);
+    minimumDwell = GetRawValue(MINIMUMDWELL_ID);
+    legato = GetRawValue(LEGATO_ID);
+    noteOffStyle = GetRawValue(NOTEOFFSTYLE_ID);
+    channelIn = GetRawValue(CHANNELIN_ID);
+    channelOut = GetRawValue(CHANNELOUT_ID);
+    pitchMode = GetRawValue(PITCHMODES_ID);
+    activeProgression = GetRawValue(ACTIVEPROGRESSION_ID);
+    transpose = GetRawValue(TRANSPOSE_ID);
+    octaveShift = GetRawValue(OCTAVESHIFT_ID);
     activeProgressionKnob = *activeProgression;
 
     for(int i=0;i<MAX_SPLITS;i++)
     {
-        splitValues[i] = apvts.getRawParameterValue(SPLITS_ID + std::to_string(i));
+        splitValues[i] = GetRawValue(GetParameterID(ParameterKind::splits, i));
     }
     *splitValues[0]=0;
-    lastChannel = 1;
 
     for(int prog=0;prog<MAX_PROGRESSIONSKNOBS;prog++)
     {
@@ -227,38 +322,132 @@ RibbonToNotesAudioProcessor::RibbonToNotesAudioProcessor()
         {
             for(int i=0;i<MAX_ZONES;i++)
             {
-                selectedKeys[prog][i] = apvts.getRawParameterValue(KEYS_ID + std::to_string(prog) + "_" + std::to_string(i));
-                selectedChord[prog][i] = apvts.getRawParameterValue(CHORDS_ID + std::to_string(prog) + "_" + std::to_string(i));
-                for(int j=0;j<MAX_NOTES;j++)
-                {
-                    chordNotes[prog][i][j] = apvts.getRawParameterValue(CHORDBUILDS_ID + std::to_string(prog) + "_" + std::to_string(i) + "_" + std::to_string(j));
-                    notesToPlay[prog][i][j] = apvts.getRawParameterValue(NOTESTOPLAY_ID 
-                                                                         + std::to_string(prog) + "_" 
-                                                                         + std::to_string(i) + "_"
-                                                                         + std::to_string(j));
-                }
-                notePressedChannel[i]=-1;
+                selectedKeys[prog][i] = GetRawValue(GetParameterID(ParameterKind::keys, prog, i));
+                selectedChord[prog][i] = GetRawValue(GetParameterID(ParameterKind::chords, prog, i));
             }
         }
-        midiInProgression[prog].MessageType = apvts.getRawParameterValue(DEFCONCAT(MIDIINMESSAGETYPE_ID, PROGRESSION) + std::to_string(prog));
-        midiInProgression[prog].Channel = apvts.getRawParameterValue(DEFCONCAT(MIDIINCHANNEL_ID, PROGRESSION) + std::to_string(prog));
-        midiInProgression[prog].Number = apvts.getRawParameterValue(DEFCONCAT(MIDIINNUMBER_ID, PROGRESSION) + std::to_string(prog));
-        midiInProgression[prog].MinValue = apvts.getRawParameterValue(DEFCONCAT(MIDIINMINVALUE_ID, PROGRESSION) + std::to_string(prog));
-        midiInProgression[prog].MaxValue = apvts.getRawParameterValue(DEFCONCAT(MIDIINMAXVALUE_ID, PROGRESSION) + std::to_string(prog));
+        midiInProgression[prog].MessageType = GetRawValue(GetParameterID(ParameterKind::midiInMessageTypeProgression, prog));
+        midiInProgression[prog].Channel = GetRawValue(GetParameterID(ParameterKind::midiInChannelProgression, prog));
+        midiInProgression[prog].Number = GetRawValue(GetParameterID(ParameterKind::midiInNumberProgression, prog));
+        midiInProgression[prog].MinValue = GetRawValue(GetParameterID(ParameterKind::midiInMinValueProgression, prog));
+        midiInProgression[prog].MaxValue = GetRawValue(GetParameterID(ParameterKind::midiInMaxValueProgression, prog));
     }
     midiInVelocity.MidiInfoID = DEFCONCAT(MIDIINMESSAGETYPE_ID, VELOCITY_ID);
-    midiInVelocity.MessageType = apvts.getRawParameterValue(DEFCONCAT(MIDIINMESSAGETYPE_ID, VELOCITY_ID));
-    midiInVelocity.Channel = apvts.getRawParameterValue(DEFCONCAT(MIDIINCHANNEL_ID, VELOCITY_ID));
-    midiInVelocity.Number = apvts.getRawParameterValue(DEFCONCAT(MIDIINNUMBER_ID, VELOCITY_ID));
-    midiInVelocity.MinValue = apvts.getRawParameterValue(DEFCONCAT(MIDIINMINVALUE_ID, VELOCITY_ID));
-    midiInVelocity.MaxValue = apvts.getRawParameterValue(DEFCONCAT(MIDIINMAXVALUE_ID, VELOCITY_ID));
-    
+    midiInVelocity.MessageType = GetRawValue(DEFCONCAT(MIDIINMESSAGETYPE_ID, VELOCITY_ID));
+    midiInVelocity.Channel = GetRawValue(DEFCONCAT(MIDIINCHANNEL_ID, VELOCITY_ID));
+    midiInVelocity.Number = GetRawValue(DEFCONCAT(MIDIINNUMBER_ID, VELOCITY_ID));
+    midiInVelocity.MinValue = GetRawValue(DEFCONCAT(MIDIINMINVALUE_ID, VELOCITY_ID));
+    midiInVelocity.MaxValue = GetRawValue(DEFCONCAT(MIDIINMAXVALUE_ID, VELOCITY_ID));
+    midiInTranspose.MidiInfoID = DEFCONCAT(MIDIINMESSAGETYPE_ID, TRANSPOSE_ID);
+    midiInTranspose.MessageType = GetRawValue(DEFCONCAT(MIDIINMESSAGETYPE_ID, TRANSPOSE_ID));
+    midiInTranspose.Channel = GetRawValue(DEFCONCAT(MIDIINCHANNEL_ID, TRANSPOSE_ID));
+    midiInTranspose.Number = GetRawValue(DEFCONCAT(MIDIINNUMBER_ID, TRANSPOSE_ID));
+    midiInTranspose.MinValue = GetRawValue(DEFCONCAT(MIDIINMINVALUE_ID, TRANSPOSE_ID));
+    midiInTranspose.MaxValue = GetRawValue(DEFCONCAT(MIDIINMAXVALUE_ID, TRANSPOSE_ID));
+    midiInOctaveShift.MidiInfoID = DEFCONCAT(MIDIINMESSAGETYPE_ID, OCTAVESHIFT_ID);
+    midiInOctaveShift.MessageType = GetRawValue(DEFCONCAT(MIDIINMESSAGETYPE_ID, OCTAVESHIFT_ID));
+    midiInOctaveShift.Channel = GetRawValue(DEFCONCAT(MIDIINCHANNEL_ID, OCTAVESHIFT_ID));
+    midiInOctaveShift.Number = GetRawValue(DEFCONCAT(MIDIINNUMBER_ID, OCTAVESHIFT_ID));
+    midiInOctaveShift.MinValue = GetRawValue(DEFCONCAT(MIDIINMINVALUE_ID, OCTAVESHIFT_ID));
+    midiInOctaveShift.MaxValue = GetRawValue(DEFCONCAT(MIDIINMAXVALUE_ID, OCTAVESHIFT_ID));
+
+    thruMessages.ensureSize(MidiThruBufferSize);
+    midiLearnBuffer.ensureSize(MidiLearnFifoSize * 8);
+
     presetManager = std::make_unique<Service::PresetManager>(apvts);
+    presetManager->onPresetParsed = [this](const juce::ValueTree& state, int request) { PreparePreset(state, request); };
+    presetManager->onPresetApplying = [this](int request) { PublishPreparedPreset(request); };
+    // the parameters of a preset are set in one transaction. The chord builds of the preset are already
+    // in the state, so the config that is compiled at the commit has the chords of the preset.
+    presetManager->onApplyParameters = [this](const std::vector<Service::PresetManager::ParameterValue>& changes)
+    {
+        ScopedTransaction transaction(*this);
+        for(const auto& change : changes)
+        {
+            SetParameterValue(*change.parameter, change.value);
+        }
+        ReadChordBuilds();
+    };
+    presetManager->onPresetLoaded = [this]
+    {
+        // the notes of the previous preset are stopped by the engine, when it gets the first config of this one
+        ReadChordBuilds();
+        appliedPresetSerial.store(configPreset.serial, std::memory_order_release);
+        UpdateEngineConfig();
+        if(applyingBankPreset == nullptr)
+        {
+            bankProgram.store(presetBankNames.indexOf(presetManager->getCurrentPreset()));
+        }
+    };
+    presetManager->onBankParsed = [this](const juce::Array<juce::ValueTree>& states) { PrepareBank(states); };
+    presetManager->onBankLoaded = [this](const juce::StringArray& presetNames, const juce::Array<juce::ValueTree>& states) { PublishBank(presetNames, states); };
+    presetManager->onPresetListChanged = [this] { UpdatePresetBank(); };
+
+    // the chord builds are a property of the state, not parameters
+    chordBuilds = ChordBuilds::CreateDefault();
+    apvts.state.setProperty(CHORDBUILDS_ID, juce::String(chordBuilds.ToState()), nullptr);
+
+    // the engine config (including the chords) is compiled by the processor, so it is also correct when the editor is not open
+    configParameterIDs.add(MIDICC_ID);
+    configParameterIDs.add(NUMBEROFZONES_ID);
+    configParameterIDs.add(CHANNELIN_ID);
+    configParameterIDs.add(CHANNELOUT_ID);
+    configParameterIDs.add(HYSTERESIS_ID);
+    configParameterIDs.add(MINIMUMDWELL_ID);
+    configParameterIDs.add(LEGATO_ID);
+    configParameterIDs.add(NOTEOFFSTYLE_ID);
+    configParameterIDs.add(OCTAVES_ID);
+    configParameterIDs.add(PITCHMODES_ID);
+    for(int i=0;i<MAX_SPLITS;i++)
+    {
+        configParameterIDs.add(GetParameterID(ParameterKind::splits, i));
+    }
+    for(int prog=0;prog<MAX_PROGRESSIONS;prog++)
+    {
+        for(int i=0;i<MAX_ZONES;i++)
+        {
+            configParameterIDs.add(GetParameterID(ParameterKind::keys, prog, i));
+        }
+    }
+    for(const auto& parameterID : configParameterIDs)
+    {
+        apvts.addParameterListener(parameterID, this);
+    }
+    EngineConfig initialConfig;
+    EngineConfig::Compile(GetEngineSettings(), initialConfig);
+    engineConfigs.reset(initialConfig);
+    config = &engineConfigs.acquire();
+
+    deliveryPolicy = GetDefaultDeliveryPolicy();
+    deliveryPolicies.reset(deliveryPolicy);
+
+    presetBankSettingsExchange.reset(presetBankSettings);
+    bankSettings = &presetBankSettingsExchange.acquire();
+    presetBanks.reset(nullptr);
+    startTimerHz(20);
+    RIBBON_STARTUP_RECORD(static_cast<const StartupProfile::Stopwatch&>(*this), constructor);
 }
 
 //==============================================================================
 RibbonToNotesAudioProcessor::~RibbonToNotesAudioProcessor()
 {
+    cancelPendingUpdate();
+    stopTimer();
+    for(const auto& parameterID : configParameterIDs)
+    {
+        apvts.removeParameterListener(parameterID, this);
+    }
+    for(const auto& stateParameter : stateParameters)
+    {
+        stateParameter.parameter->removeListener(this);
+    }
+    apvts.state.removeListener(this);
+   #if RIBBON_REALTIME_AUDIT
+    RealtimeAudit::PrintReport(stderr);
+   #endif
+   #if RIBBON_STARTUP_PROFILE
+    StartupProfile::PrintReport(stderr);
+   #endif
 }
 
 //==============================================================================
@@ -328,12 +517,18 @@ void RibbonToNotesAudioProcessor::prepareToPlay (double sampleRate, int samplesP
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
+    // All buffers used on the audio thread are allocated here, so processBlock does not have to.
+    ribbonEngine.Prepare(sampleRate, samplesPerBlock);
+    preparedSamplesPerBlock.store(samplesPerBlock, std::memory_order_relaxed);
+    thruMessages.ensureSize(MidiThruBufferSize);
 }
 
 void RibbonToNotesAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    // No midi can be sent from here, so the notes that are still sounding are stopped in the next block.
+    stopNotesRequested = true;
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -363,43 +558,56 @@ bool RibbonToNotesAudioProcessor::isBusesLayoutSupported (const BusesLayout& lay
 #endif
 
 //return true if de controller message is the selected controller message.
-bool RibbonToNotesAudioProcessor::PlayMidi(int &ccval, int &channel, const juce::MidiMessage &message)
+void RibbonToNotesAudioProcessor::PlayMidi(const juce::MidiMessage &message, int samplePosition)
 {
-    if(message.isController() && message.getControllerNumber() == (int) *midiCC)
+    //ccval linked to the ribbon? Then play notes or stop playing notes based on the cc value,
+    //at the same sample as the cc message, so every zone that is crossed within the block is played.
+    if(ribbonEngine.HandleMidi(message.getRawData(), message.getRawDataSize(), samplePosition))
     {
-        ccval = message.getControllerValue();
-        channel = message.getChannel();
-        return true;
+        return;
+    }
+    //program change or learned control that selects a preset of the bank, from this sample on
+    if(SelectBankPreset(message, samplePosition))
+    {
+        return;
+    }
+    //not a ccval linked to the ribbon: pass on everything that is not a learned control
+    //without delay, at its original position
+    if(SetControlByMidi(message))
+    {
+        ribbonEngine.SetActiveProgression(getActiveProgression());
+        ribbonEngine.SetVelocity(GetNoteVelocity());
+        ribbonEngine.SetNoteOffset(GetNoteOffset());
     }
-    //not a ccval linked to the ribbon
     else
     {
-        if(SetControlByMidi(message) == false)
-        {
-            notesToPlayBuffer.addEvent(message, juce::Time::getMillisecondCounterHiRes() * 0.001 - startTime);
-        }
+        thruMessages.addEvent(message, samplePosition);
     }
-    return false;
 }
 
-void RibbonToNotesAudioProcessor::LearnMidi(const juce::MidiMessage &message) 
+void RibbonToNotesAudioProcessor::LearnMidi(const juce::MidiMessage &message, int samplePosition)
 {
-    if(MidiLearnInterface::MidiLearnOn)
+    // the editor reads the messages on the message thread. Only short messages can be learned,
+    // and messages that do not fit in the fifo are dropped.
+    if(MidiLearnInterface::MidiLearnOn && message.getRawDataSize() <= 3)
     {
-        midiLearnBuffer.addEvent(message, juce::Time::getMillisecondCounterHiRes() * 0.001 - startTime);
-    }
-    else
-    {
-        midiLearnBuffer.clear();
+        const auto scope = midiLearnFifo.write(1);
+        if(scope.blockSize1 > 0)
+        {
+            auto& learnMessage = midiLearnMessages[(size_t) scope.startIndex1];
+            learnMessage.size = message.getRawDataSize();
+            std::memcpy(learnMessage.data, message.getRawData(), (size_t) learnMessage.size);
+            learnMessage.time = juce::Time::getMillisecondCounterHiRes() * 0.001 - startTime;
+        }
     }
     if(message.isNoteOff() || message.isAllNotesOff() || message.isNoteOn())
     {
         auto notemessageOrg = juce::MidiMessage(message);
         notemessageOrg.setVelocity(0.0);// just in case the note was pressed before midi learn was switched on.
-        notesToPlayBuffer.addEvent(notemessageOrg, juce::Time::getMillisecondCounterHiRes() * 0.001 - startTime);
+        thruMessages.addEvent(notemessageOrg, samplePosition);
         auto notemessage = juce::MidiMessage(message);
-        notemessage.setChannel(fmax((int)*channelOut,1));
-        notesToPlayBuffer.addEvent(notemessage, juce::Time::getMillisecondCounterHiRes() * 0.001 - startTime);
+        notemessage.setChannel(std::max(config->channelOut,1));
+        thruMessages.addEvent(notemessage, samplePosition);
     }
 }
 
@@ -409,6 +617,9 @@ void RibbonToNotesAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
     // A pure MIDI plugin shouldn't be provided any audio data
     //jassert (buffer.getNumChannels() == 0);
     
+    // in a RIBBON_REALTIME_AUDIT build, every allocation and lock from here on is counted
+    RIBBON_REALTIME_SECTION();
+    
     // however we use the buffer to get timing information
     auto numSamples = buffer.getNumSamples();
     
@@ -420,37 +631,56 @@ void RibbonToNotesAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
     // interleaved by keeping the same state.
     
     buffer.clear();
-        
-    int ccval = lastCCValue;
-    int channel = lastChannel;
-    bool ccPlayNotes = false;
+
+    // get the latest settings. The config does not change for the rest of the block.
+    BeginEngineBlock();
+
+    // stop the notes when the transport stops
+    if(auto* playHead = getPlayHead())
+    {
+        if(auto position = playHead->getPosition())
+        {
+            auto isPlaying = position->getIsPlaying();
+            if(wasPlaying && !isPlaying)
+            {
+                stopNotesRequested = true;
+            }
+            wasPlaying = isPlaying;
+        }
+    }
+    if(stopNotesRequested.exchange(false))
+    {
+        ribbonEngine.StopAllSoundingNotes(0);
+    }
+
+    // zone pressed in the editor
+    auto requestedCC = requestedCCValue.exchange(-1);
+    if(requestedCC >= 0)
+    {
+        ribbonEngine.PlayValue(requestedCC, std::max(config->channelOut,1), 0);
+    }
+
     //filter the cc mesagges of the selected midiCC
     for(const auto metadata : midiMessages)
     {
         const auto message = metadata.getMessage();
-        //auto time = metadata.samplePosition;
+        const auto time = metadata.samplePosition;
         if(MidiLearnInterface::MidiSettingOn == false && MidiLearnInterface::MidiLearnOn == false)
         {
-            //ccval linked to the ribbon?
-            if(PlayMidi(ccval, channel, message))
-            {
-                ccPlayNotes = true;
-            }
+            PlayMidi(message, time);
         }
         else
         {
-            LearnMidi(message);
+            LearnMidi(message, time);
         }
     }
+    // the output starts with the passed on midi. It is copied, not swapped, so thruMessages keeps its
+    // preallocated storage. The passed on midi is never more than the input, so it fits in the storage
+    // of the host buffer (learned notes excepted), and the host buffer keeps its own storage.
     midiMessages.clear();
+    midiMessages.addEvents(thruMessages, 0, -1, 0);
+    thruMessages.clear();
 
-    //play notes or stop playing notes based on the cc value
-    if(ccPlayNotes && HasChanged(ccval))
-    {
-        AddNotesToPlayToBuffer(ccval, channel, notesToPlayBuffer);
-    }
-    lastCCValue = ccval;
-    
     // some programs do not except multiple messages added to the buffer.
     // so adding the notes one by one solves this problem
     // Mind you that processblock fires each sample time, so for the user
@@ -458,40 +688,86 @@ void RibbonToNotesAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
     PlayNextMidiMessages(midiMessages,0,numSamples);
 }
 
-// plays the first of the buffered notes, and removes it from the buffer
+// when bypassed, the incoming midi is passed on as it is. Notes that are still sounding are stopped,
+// and queued notes are dropped so they can not start after the note offs.
+void RibbonToNotesAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    RIBBON_REALTIME_SECTION();
+    buffer.clear();
+    BeginEngineBlock();
+    ribbonEngine.Flush(buffer.getNumSamples(), [&](const MidiEvent& event, int position)
+    {
+        midiMessages.addEvent(event.data, event.size, position);
+    });
+    stopNotesRequested = false;
+    activeZone = ribbonEngine.GetActiveZone();
+}
+
+void RibbonToNotesAudioProcessor::BeginEngineBlock()
+{
+    bankSettings = &presetBankSettingsExchange.acquire();
+    const auto* newBank = presetBanks.acquire().get();
+    // a preset selected from the bank is played until its parameters are set, or until the bank changes
+    if(newBank != bank || appliedBankSelection.load(std::memory_order_acquire) == bankSelections)
+    {
+        bankConfig = nullptr;
+    }
+    bank = newBank;
+    config = bankConfig != nullptr ? bankConfig : &engineConfigs.acquire();
+    // a preset that is loaded in the background brings its own progression, velocity and note offset, until its parameters are set
+    const bool presetPending = config->preset.serial != appliedPresetSerial.load(std::memory_order_acquire);
+    ribbonEngine.BeginBlock(*config,
+                            presetPending ? config->preset.activeProgression : getActiveProgression(),
+                            presetPending ? config->preset.velocity : GetNoteVelocity(),
+                            deliveryPolicies.acquire());
+    ribbonEngine.SetNoteOffset(presetPending ? config->preset.noteOffset : GetNoteOffset());
+}
+
+// plays the first of the queued notes, and removes it from the queue
 void RibbonToNotesAudioProcessor::PlayNextMidiMessages(juce::MidiBuffer &midiMessages,
                                                const int startSample,
                                                const int numSamples)
 {
-    juce::MidiBuffer tmpBuffer;
-    int i = 0;
-
-    const int firstEventToAdd = notesToPlayBuffer.getFirstEventTime();
-    const double scaleFactor = numSamples / (double) (notesToPlayBuffer.getLastEventTime() + 1 - firstEventToAdd);
+    // the delivery policy decides how many of the queued messages are played in this block.
+    // The messages that are left are played in the next blocks.
+    auto delay = ribbonEngine.EndBlock(numSamples, [&](const MidiEvent& event, int position)
+    {
+        midiMessages.addEvent (event.data, event.size, startSample + position);
+    });
+    activeZone = ribbonEngine.GetActiveZone();
+    if(delay > maxDeliveryLatency.load(std::memory_order_relaxed))
+    {
+        maxDeliveryLatency.store(delay, std::memory_order_relaxed);
+    }
+}
 
-    for(const auto metadata : notesToPlayBuffer)
+//==============================================================================
+// Delivery policy
+//==============================================================================
+// Blue Cat's Patchwork does not accept multiple messages in one buffer, so it gets one message per block.
+// Only for small blocks: with large blocks the delay gets too noticeable. Other hosts get every message
+// at the sample it was created.
+// No latency is reported to the host: the passed on midi and the first note of a change are not delayed,
+// only the rest of the change is, and late notes that are stopped before they are played are dropped.
+// How late the rest can be is bounded by getDeliveryLatency, which the editor shows and RibbonBenchmark checks.
+DeliveryPolicy RibbonToNotesAudioProcessor::GetDefaultDeliveryPolicy()
+{
+    DeliveryPolicy policy;
+    if(juce::PluginHostType::getHostPath().containsIgnoreCase("PatchWork"))
     {
-        const auto pos = juce::jlimit (0, numSamples - 1, juce::roundToInt ((metadata.samplePosition - firstEventToAdd) * scaleFactor));
-        auto message = metadata.getMessage();
-        
-        //workaround to avoid problems in Blue Cat's Patchwork. Not to happy with this, because it introduces
-        //unecessary latency. That is why I only apply it for small buffers. With large buffer sizes, the latency gets
-        //to much noticeable.
-        if(i<1 || numSamples > 256)
-        {
-            // add message to be excecuted
-            midiMessages.addEvent (message, startSample + pos);
-        }
-        else
-        {
-            // other messages are not executed but copied to temporary buffer. This is needed for Blue Cat's Patchwork
-            // In Logic it is not a problem to have a buffer with multiple messages.
-            tmpBuffer.addEvent(message, juce::Time::getMillisecondCounterHiRes() * 0.001 - startTime);
-        }
-        i++;
+        policy.mode = DeliveryMode::eventsPerBlock;
+        policy.eventsPerBlock = 1;
+        policy.maxBlockSize = 256;
     }
-    // swap the buffer, so the excuted message is removed from the buffer.
-    notesToPlayBuffer.swapWith(tmpBuffer);
+    return policy;
+}
+
+void RibbonToNotesAudioProcessor::SetDeliveryPolicy(const DeliveryPolicy& policy)
+{
+    deliveryPolicy = policy;
+    StateChanged();
+    deliveryPolicies.publish(deliveryPolicy);
+    resetMaxDeliveryLatency();
 }
 //==============================================================================
 bool RibbonToNotesAudioProcessor::hasEditor() const
@@ -501,34 +777,144 @@ bool RibbonToNotesAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* RibbonToNotesAudioProcessor::createEditor()
 {
+    RIBBON_STARTUP_TIMER(createEditor);
     return new RibbonToNotesAudioProcessorEditor (*this);
 }
 
 //==============================================================================
 void RibbonToNotesAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
+    RIBBON_STARTUP_TIMER(getState);
     // You should use this method to store your parameters in the memory block.
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml (state.createXml());
-    copyXmlToBinary (*xml, destData);
+    // Hosts call this with every autosave, so the values are written as they are, without the parameter tree,
+    // and only when something changed since the last time.
+    const juce::ScopedLock lock(savedStateLock);
+    // read before the values: a change while they are written raises it again, so it is not missed
+    auto version = GetStateVersion();
+    if(version != savedStateVersion)
+    {
+        BinaryState state;
+        state.parameters.reserve(stateParameters.size());
+        for(const auto& stateParameter : stateParameters)
+        {
+            state.parameters.push_back({stateParameter.idHash, stateParameter.value->load()});
+        }
+        state.chordBuilds = chordBuilds.ToBytes();
+        // the delivery policy belongs to the host, not to a preset, so it is kept outside of the parameters
+        state.deliveryPolicy = deliveryPolicy;
+        state.presetName = apvts.state.getProperty(Service::PresetManager::presetNameProperty).toString().toStdString();
+        state.pluginVersion = ProjectInfo::versionString;
+        state.presetBank = presetBankSettings;
+
+        savedState.setSize(state.GetSize());
+        state.Write(static_cast<std::uint8_t*>(savedState.getData()));
+        savedStateVersion = version;
+    }
+    destData.replaceAll(savedState.getData(), savedState.getSize());
 }
 
 void RibbonToNotesAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    RIBBON_STARTUP_TIMER(setState);
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
+    BinaryState state;
+    if(state.Read(data, (std::size_t) juce::jmax(0, sizeInBytes)))
+    {
+        ReadBinaryState(state);
+    }
+    else if(! ReadXmlState(data, sizeInBytes))
+    {
+        return;
+    }
+    ReadChordBuilds();
+    UpdateEngineConfig();
+    stopNotesRequested = true;
+}
+
+void RibbonToNotesAudioProcessor::ReadBinaryState(const BinaryState& state)
+{
+    // parameters that are not in the state get their default value, like replaceState does
+    std::vector<bool> isInState(stateParameters.size(), false);
+    for(const auto& value : state.parameters)
+    {
+        if(auto* match = FindStateParameter(value.idHash))
+        {
+            isInState[(std::size_t) (match - stateParameters.data())] = true;
+            // compared with the raw value, which is what the engine reads. It can differ from the value
+            // of the parameter when it was written directly (MIDI learned velocity)
+            auto normalisedValue = match->parameter->convertTo0to1(value.value);
+            if(match->value->load() != match->parameter->convertFrom0to1(normalisedValue))
+            {
+                match->parameter->setValueNotifyingHost(normalisedValue);
+            }
+        }
+    }
+    for(std::size_t i=0;i<stateParameters.size();i++)
+    {
+        auto* parameter = stateParameters[i].parameter;
+        if(! isInState[i] && stateParameters[i].value->load() != parameter->convertFrom0to1(parameter->getDefaultValue()))
+        {
+            parameter->setValueNotifyingHost(parameter->getDefaultValue());
+        }
+    }
+
+    SetDeliveryPolicy(state.deliveryPolicy);
+    SetPresetBankSettings(state.presetBank);
+
+    // chord builds of an unknown version are reset to the default
+    auto builds = ChordBuilds::CreateDefault();
+    builds.FromBytes(state.chordBuilds.data(), state.chordBuilds.size());
+    apvts.state.setProperty(CHORDBUILDS_ID, juce::String(builds.ToState()), nullptr);
+    apvts.state.setProperty(Service::PresetManager::presetNameProperty,
+                            juce::String::fromUTF8(state.presetName.data(), (int) state.presetName.size()), nullptr);
+    apvts.state.setProperty("version", juce::String::fromUTF8(state.pluginVersion.data(), (int) state.pluginVersion.size()), nullptr);
+}
+
+const RibbonToNotesAudioProcessor::StateParameter* RibbonToNotesAudioProcessor::FindStateParameter(std::uint32_t idHash) const
+{
+    auto match = std::lower_bound(stateParameters.begin(), stateParameters.end(), idHash,
+                                  [](const StateParameter& stateParameter, std::uint32_t hash) { return stateParameter.idHash < hash; });
+    return match != stateParameters.end() && match->idHash == idHash ? &*match : nullptr;
+}
+
+std::atomic<float>* RibbonToNotesAudioProcessor::GetRawValue(const char* parameterID) const
+{
+    auto* stateParameter = FindStateParameter(BinaryState::HashID(parameterID));
+    jassert(stateParameter != nullptr); // not a parameter of CreateParameterLayout
+    return stateParameter != nullptr ? stateParameter->value : nullptr;
+}
+
+bool RibbonToNotesAudioProcessor::ReadXmlState(const void* data, int sizeInBytes)
+{
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
     
-    if (xmlState.get() != nullptr)
-        if (xmlState->hasTagName (apvts.state.getType()))
-            apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
+    if (xmlState.get() == nullptr || ! xmlState->hasTagName (apvts.state.getType()))
+        return false;
+
+    if(auto* delivery = xmlState->getChildByName(DELIVERY_TAG))
+    {
+        DeliveryPolicy policy;
+        policy.mode = (DeliveryMode) juce::jlimit(0, 2, delivery->getIntAttribute("mode", (int) policy.mode));
+        policy.eventsPerBlock = delivery->getIntAttribute("eventsPerBlock", policy.eventsPerBlock);
+        policy.spreadSamples = delivery->getIntAttribute("spreadSamples", policy.spreadSamples);
+        policy.maxBlockSize = delivery->getIntAttribute("maxBlockSize", policy.maxBlockSize);
+        xmlState->removeChildElement(delivery, true);
+        SetDeliveryPolicy(policy);
+    }
+    auto state = juce::ValueTree::fromXml (*xmlState);
+    Service::PresetManager::migrateState(state);
+    apvts.replaceState (state);
+    return true;
 }
 
 int RibbonToNotesAudioProcessor::getActiveProgression() const
 {
-    return (int) *activeProgression;
+    // a progression selected by a learned control is used until the message thread has set the parameter
+    const auto learned = learnedProgression.load();
+    return learned != NoLearnedValue ? learned : (int) *activeProgression;
 }
 
 
@@ -547,105 +933,28 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 //==============================================================================
 // functions for adding the note on and offs to the buffer
 //==============================================================================
+// called from the editor. The notes are added on the audio thread at the start of the next block,
+// because the queue is owned by the audio thread.
 void RibbonToNotesAudioProcessor::AddNotesToPlayToBuffer(int ccval)
 {
-    AddNotesToPlayToBuffer(ccval, std::max((int) *channelOut,1), notesToPlayBuffer);
+    requestedCCValue.store(ccval);
 }
 
-void RibbonToNotesAudioProcessor::AddNotesToPlayToBuffer(int ccval, int channel, juce::MidiBuffer &midiMessages)
+// velocity of the notes, as a midi value
+std::uint8_t RibbonToNotesAudioProcessor::GetNoteVelocity() const
 {
-    // if listening to specific channels and channel is not the same, do nothing
-    if((int) *channelIn != 0 && channel != (int) *channelIn)
-    {
-        return;
-    }
-    
-    // if specific channel out has been set, change the channel
-    if((int) *channelOut != 0)
-    {
-        channel = (int) *channelOut;
-    }
-    
-    // determine selected zone
-    for(int zone=0 ; zone < ((int)(*numberOfZones)) ;zone++)
-    {
-        if(ccval <= *splitValues[0])
-        {
-            if(channel != lastChannel)
-            {
-                AddSentAllNotesOff(midiMessages,lastChannel);
-            }
-            AddPreviousNotesSentNotesOff(midiMessages, channel);
-            activeZone = 0;
-            break;
-        }
-        
-        //if ccval is in range according to spliValues array, start the note
-        if(ccval < *splitValues[zone+1])
-        {
-            //only do something if the same note is not already pressed
-            if(activeZone != zone+1)//notePressedChannel[i] != channel)
-            {
-                activeZone = zone+1;
-                //first sent noteOff for previous notes.
-                AddPreviousNotesSentNotesOff(midiMessages, channel);
-                //create new noteOn
-                notePressedChannel[zone] = channel;
-                AddSentNotesOn(midiMessages, getActiveProgression(), zone, channel);
-            }
-            
-            //stop the loop as soon as a range was valid
-            break;
-        }
-    }
-    lastChannel = channel;
-}
-// add an all notes off to the buffer for given channel and any other channel that was previously used
-void RibbonToNotesAudioProcessor::AddSentAllNotesOff(juce::MidiBuffer& processedMidi, int channel)
-{
-    processedMidi.addEvent(juce::MidiMessage::allNotesOff(channel), juce::Time::getMillisecondCounterHiRes() * 0.001 - startTime);
-    
-    //loop through array
-    for(int i=0;i<MAX_ZONES;i++)
-    {
-        //if note was pressed, the channel was set.
-        if(notePressedChannel[i]>0)
-        {
-            processedMidi.addEvent(juce::MidiMessage::allNotesOff(notePressedChannel[i]), juce::Time::getMillisecondCounterHiRes() * 0.001 - startTime);
-            notePressedChannel[i]=-1; //remove the channel setting, because all notes have been cleared
-        }
-    }
+    return (std::uint8_t) juce::jlimit(0, 127, juce::roundToInt(*noteVelocity * 127.0f));
 }
 
-// add notes off for previous played notes on the selected channel
-void RibbonToNotesAudioProcessor::AddPreviousNotesSentNotesOff(juce::MidiBuffer& processedMidi, int channel)
+// transpose and octave shift, in semitones. Added to the notes when the engine starts them,
+// so a key change does not touch the keys of the progressions.
+int RibbonToNotesAudioProcessor::GetNoteOffset() const
 {
-    //loop through array
-    for(int i = 0; i < notesPressed.size(); i++)
-    {
-        auto note =notesPressed[i];
-        
-        auto message1 = juce::MidiMessage::noteOn(channel, note, 0.0f);
-        processedMidi.addEvent(message1, juce::Time::getMillisecondCounterHiRes() * 0.001 - startTime);
-        
-        auto message2 = juce::MidiMessage::noteOff(channel,note);
-        processedMidi.addEvent(message2, juce::Time::getMillisecondCounterHiRes() * 0.001 - startTime);
-    }
-    notesPressed.removeRange(0,notesPressed.size());
-}
-
-// add notes on for the selected zone on the given channel
-void RibbonToNotesAudioProcessor::AddSentNotesOn(juce::MidiBuffer& processedMidi, int selectedAlt, int selectedZone, int channel)
-{
-    //loop through array
-    for(int j=0;j<MAX_NOTES;j++)
-    {
-        int note = (int) *notesToPlay[selectedAlt][selectedZone][j];
-        if(((int)(*chordNotes[selectedAlt][selectedZone][j]))==NONOTE) break;
-        auto message = juce::MidiMessage::noteOn(channel,note,*noteVelocity);
-        processedMidi.addEvent(message, juce::Time::getMillisecondCounterHiRes() * 0.001 - startTime);
-        notesPressed.add(note);
-    }
+    const auto learnedSemitones = learnedTranspose.load();
+    const auto learnedOctaves = learnedOctaveShift.load();
+    const auto semitones = learnedSemitones != NoLearnedValue ? learnedSemitones : juce::roundToInt(transpose->load());
+    const auto octaves = learnedOctaves != NoLearnedValue ? learnedOctaves : juce::roundToInt(octaveShift->load());
+    return semitones + 12 * octaves;
 }
 //==============================================================================
 // Select progression
@@ -660,10 +969,25 @@ bool RibbonToNotesAudioProcessor::SetControlByMidi(const juce::MidiMessage &midi
     {
         auto messageValue = messageType == 1 ? midiMessage.getControllerValue() : midiMessage.getVelocity();
         *noteVelocity = (*midiInVelocity.MinValue + (*midiInVelocity.MaxValue - *midiInVelocity.MinValue) * messageValue / 127.0) / 127.0;
+        StateChanged();
+        return true;
+    }
+    //controller value that transposes or shifts the octave? Heard from the next chord on,
+    //the parameter is set by the message thread, see timerCallback
+    if(midiInTranspose.MidiMessageComplies(midiMessage))
+    {
+        auto messageValue = messageType == 1 ? midiMessage.getControllerValue() : midiMessage.getVelocity();
+        learnedTranspose.store(GetLearnedOffset((int) *midiInTranspose.MinValue, (int) *midiInTranspose.MaxValue, messageValue, MAX_TRANSPOSE));
+        return true;
+    }
+    if(midiInOctaveShift.MidiMessageComplies(midiMessage))
+    {
+        auto messageValue = messageType == 1 ? midiMessage.getControllerValue() : midiMessage.getVelocity();
+        learnedOctaveShift.store(GetLearnedOffset((int) *midiInOctaveShift.MinValue, (int) *midiInOctaveShift.MaxValue, messageValue, MAX_OCTAVESHIFT));
         return true;
     }
 
-    int ap = ((int) *activeProgression);
+    int ap = getActiveProgression();
     for(int i=0; i < MAX_PROGRESSIONSKNOBS;i++)
     {
         if(midiInProgression[i].MidiMessageComplies(midiMessage))
@@ -682,27 +1006,429 @@ bool RibbonToNotesAudioProcessor::SetControlByMidi(const juce::MidiMessage &midi
                 ap++;
                 ap = ap < MAX_PROGRESSIONS ? ap : 0;
             }
-            UpdateParameter(ap, ACTIVEPROGRESSION_ID);
+            // the parameter is set by the message thread, see timerCallback
+            learnedProgression.store(ap);
             return true;
         }
     }
     return false;
 }
 
+//==============================================================================
+// compile the settings and chords for the audio thread
+//==============================================================================
+void RibbonToNotesAudioProcessor::UpdateEngineConfig()
+{
+    EngineConfig newConfig;
+    EngineConfig::Compile(GetEngineSettings(), newConfig);
+    newConfig.preset = configPreset;
+    engineConfigs.publish(newConfig);
+}
+
+//==============================================================================
+// Presets loaded in the background
+//==============================================================================
+// the config the engine gets when the state is applied
+void RibbonToNotesAudioProcessor::CompilePreset(const juce::ValueTree& state, EngineConfig& presetConfig)
+{
+    auto parameters = EngineParameters::CreateDefault();
+    for(const auto& child : state)
+    {
+        parameters.SetParameter(child.getProperty("id").toString().toStdString(), (float) child.getProperty("value"));
+    }
+    parameters.settings.chords.chordNotes.FromState(state.getProperty(CHORDBUILDS_ID).toString().toStdString());
+
+    EngineConfig::Compile(parameters.settings, presetConfig);
+    presetConfig.preset.activeProgression = parameters.activeProgression;
+    presetConfig.preset.velocity = parameters.GetMidiVelocity();
+    presetConfig.preset.noteOffset = parameters.GetNoteOffset();
+}
+
+void RibbonToNotesAudioProcessor::PreparePreset(const juce::ValueTree& state, int request)
+{
+    auto prepared = std::make_unique<EngineConfig>();
+    CompilePreset(state, *prepared);
+
+    const juce::ScopedLock lock(preparedPresetLock);
+    preparedPreset = std::move(prepared);
+    preparedPresetRequest = request;
+}
+
+void RibbonToNotesAudioProcessor::PublishPreparedPreset(int request)
+{
+    // a preset of the bank is already played by the audio thread
+    if(applyingBankPreset != nullptr)
+    {
+        configPreset = *applyingBankPreset;
+        return;
+    }
+    std::unique_ptr<EngineConfig> prepared;
+    {
+        // a preset file that was dropped can be parsed after the preset that is applied, its config is not published
+        const juce::ScopedLock lock(preparedPresetLock);
+        if(preparedPresetRequest == request)
+        {
+            prepared = std::move(preparedPreset);
+        }
+        preparedPreset.reset();
+    }
+    // without a prepared config, the notes are stopped by the config compiled after the parameters are set
+    configPreset.serial = ++lastPresetSerial;
+    if(prepared != nullptr)
+    {
+        configPreset.activeProgression = prepared->preset.activeProgression;
+        configPreset.velocity = prepared->preset.velocity;
+        configPreset.noteOffset = prepared->preset.noteOffset;
+        prepared->preset = configPreset;
+        engineConfigs.publish(*prepared);
+    }
+}
+
+//==============================================================================
+// Preset bank
+//==============================================================================
+void RibbonToNotesAudioProcessor::SetPresetBankSettings(const PresetBankSettings& settings)
+{
+    const bool enabledChanged = settings.enabled != presetBankSettings.enabled;
+    presetBankSettings = settings;
+    StateChanged();
+    presetBankSettingsExchange.publish(presetBankSettings);
+    if(enabledChanged)
+    {
+        UpdatePresetBank();
+    }
+}
+
+// (re)reads the presets of the bank, or removes the bank when it is disabled
+void RibbonToNotesAudioProcessor::UpdatePresetBank()
+{
+    if(presetBankSettings.enabled)
+    {
+        presetManager->loadBank(PresetBank::MaxPresets);
+        return;
+    }
+    presetBank = nullptr;
+    presetBankNames.clear();
+    presetBankStates.clear();
+    presetBanks.publish(nullptr);
+}
+
+void RibbonToNotesAudioProcessor::PrepareBank(const juce::Array<juce::ValueTree>& states)
+{
+    auto prepared = std::make_shared<PresetBank>();
+    prepared->numPresets = juce::jmin(states.size(), PresetBank::MaxPresets);
+    for(int i=0;i<prepared->numPresets;i++)
+    {
+        CompilePreset(states.getReference(i), prepared->presets[i]);
+    }
+
+    const juce::ScopedLock lock(preparedPresetLock);
+    preparedBank = std::move(prepared);
+}
+
+void RibbonToNotesAudioProcessor::PublishBank(const juce::StringArray& presetNames, const juce::Array<juce::ValueTree>& states)
+{
+    std::shared_ptr<PresetBank> prepared;
+    {
+        const juce::ScopedLock lock(preparedPresetLock);
+        prepared = std::move(preparedBank);
+    }
+    if(prepared == nullptr || ! presetBankSettings.enabled)
+    {
+        return;
+    }
+    // every preset has its own serial, so the engine stops the notes of the previous one when it switches
+    for(int i=0;i<prepared->numPresets;i++)
+    {
+        prepared->presets[i].preset.serial = ++lastPresetSerial;
+    }
+    presetBank = prepared;
+    presetBankNames = presetNames;
+    presetBankStates = states;
+    bankProgram.store(presetBankNames.indexOf(presetManager->getCurrentPreset()));
+    // the previous bank is released here (by a later publish), never on the audio thread
+    presetBanks.publish(presetBank);
+}
+
+bool RibbonToNotesAudioProcessor::SelectBankPreset(const juce::MidiMessage& message, int samplePosition)
+{
+    if(learnPresetControl.load(std::memory_order_relaxed) != 0 && (message.isController() || message.isNoteOn()))
+    {
+        const int target = learnPresetControl.exchange(0);
+        const int messageType = message.isController() ? 1 : 2;
+        const int number = messageType == 1 ? message.getControllerNumber() : message.getNoteNumber();
+        learnedPresetControl.store(target | messageType << 4 | message.getChannel() << 8 | number << 16);
+        return true;
+    }
+    if(bank == nullptr || bank->numPresets == 0)
+    {
+        return false;
+    }
+
+    int program;
+    int value;
+    if(message.isProgramChange())
+    {
+        if(config->channelIn != 0 && message.getChannel() != config->channelIn)
+        {
+            return false;
+        }
+        program = message.getProgramChangeNumber();
+    }
+    else if(bankSettings->next.Complies(message.getRawData(), message.getRawDataSize(), value))
+    {
+        program = (bankProgram.load() + 1) % bank->numPresets;
+    }
+    else if(bankSettings->previous.Complies(message.getRawData(), message.getRawDataSize(), value))
+    {
+        program = bankProgram.load() - 1;
+        program = program < 0 ? bank->numPresets - 1 : program;
+    }
+    else
+    {
+        return false;
+    }
+    // program changes outside of the bank are passed on
+    if(program >= bank->numPresets)
+    {
+        return false;
+    }
+
+    bankConfig = &bank->presets[program];
+    config = bankConfig;
+    ribbonEngine.SetConfig(*bankConfig, samplePosition);
+    bankProgram.store(program);
+    bankSelection.store(++bankSelections, std::memory_order_release);
+    return true;
+}
+
+// sets the parameters of a preset that was selected on the audio thread
+void RibbonToNotesAudioProcessor::ApplyBankPreset(int program, std::uint32_t selection)
+{
+    if(presetBank != nullptr && program >= 0 && program < presetBankStates.size())
+    {
+        applyingBankPreset = &presetBank->presets[program].preset;
+        presetManager->applyBankPreset(presetBankStates.getReference(program), presetBankNames[program]);
+        applyingBankPreset = nullptr;
+    }
+    appliedBankSelection.store(selection, std::memory_order_release);
+}
+
+void RibbonToNotesAudioProcessor::timerCallback()
+{
+    if(auto learned = learnedPresetControl.exchange(0))
+    {
+        // a cc is a footswitch: it steps when it is pressed, not when it is released
+        const int messageType = (learned >> 4) & 0x0f;
+        const LearnedControl control {messageType, (learned >> 8) & 0xff, (learned >> 16) & 0xff, messageType == 1 ? 64 : 1, 128};
+        auto settings = presetBankSettings;
+        ((learned & 0x0f) == 1 ? settings.next : settings.previous) = control;
+        SetPresetBankSettings(settings);
+    }
+    const auto selection = bankSelection.load(std::memory_order_acquire);
+    if(selection != appliedBankSelection.load(std::memory_order_relaxed))
+    {
+        ApplyBankPreset(bankProgram.load(), selection);
+    }
+    ApplyLearnedValue(learnedProgression, ACTIVEPROGRESSION_ID);
+    ApplyLearnedValue(learnedTranspose, TRANSPOSE_ID);
+    ApplyLearnedValue(learnedOctaveShift, OCTAVESHIFT_ID);
+}
+
+// sets the parameter to the value of a learned control, and stops using the learned value
+// unless the audio thread has received a newer one in the meantime
+void RibbonToNotesAudioProcessor::ApplyLearnedValue(std::atomic<int>& learnedValue, const char* parameterID)
+{
+    auto value = learnedValue.load();
+    if(value == NoLearnedValue)
+    {
+        return;
+    }
+    UpdateParameter(value, parameterID);
+    learnedValue.compare_exchange_strong(value, NoLearnedValue);
+}
+
+// moves the messages the audio thread received for midi learn to midiLearnBuffer
+void RibbonToNotesAudioProcessor::ReadMidiLearnMessages()
+{
+    const auto scope = midiLearnFifo.read(midiLearnFifo.getNumReady());
+    scope.forEach([this](int index)
+    {
+        const auto& learnMessage = midiLearnMessages[(size_t) index];
+        if(MidiLearnInterface::MidiLearnOn)
+        {
+            midiLearnBuffer.addEvent(learnMessage.data, learnMessage.size, (int) learnMessage.time);
+        }
+    });
+    if(! MidiLearnInterface::MidiLearnOn)
+    {
+        midiLearnBuffer.clear();
+    }
+}
+
+EngineSettings RibbonToNotesAudioProcessor::GetEngineSettings() const
+{
+    EngineSettings settings;
+    settings.midiCC = (int) *midiCC;
+    settings.numberOfZones = (int) *numberOfZones;
+    for(int i=0;i<MAX_SPLITS;i++)
+    {
+        settings.splitValues[i] = (int) *splitValues[i];
+    }
+    settings.channelIn = (int) *channelIn;
+    settings.channelOut = (int) *channelOut;
+    settings.hysteresis = (int) *hysteresis;
+    settings.minimumDwellMs = (int) *minimumDwell;
+    settings.legato = *legato > 0.5f;
+    settings.noteOffStyle = (int) *noteOffStyle;
+    settings.chords = GetChordSettings();
+    return settings;
+}
+
+ChordSettings RibbonToNotesAudioProcessor::GetChordSettings() const
+{
+    ChordSettings settings;
+    settings.octave = (int) *octaves;
+    settings.pitchMode = (int) *pitchMode;
+    for(int prog=0;prog<MAX_PROGRESSIONS;prog++)
+    {
+        for(int zone=0;zone<MAX_ZONES;zone++)
+        {
+            settings.keys[prog][zone] = (int) *selectedKeys[prog][zone];
+        }
+    }
+    settings.chordNotes = chordBuilds;
+    return settings;
+}
+
+//==============================================================================
+// Chord builds
+//==============================================================================
+void RibbonToNotesAudioProcessor::SetChordBuild(int progression, int zone, const int* intervals)
+{
+    for(int note=0;note<MAX_NOTES;note++)
+    {
+        chordBuilds.Set(progression, zone, note, intervals[note]);
+    }
+    if(transactionDepth > 0)
+    {
+        chordBuildsChanged = true;
+        return;
+    }
+    apvts.state.setProperty(CHORDBUILDS_ID, juce::String(chordBuilds.ToState()), nullptr);
+    triggerAsyncUpdate();
+}
+
+// reads the chord builds from the state, after a state or preset has been loaded
+void RibbonToNotesAudioProcessor::ReadChordBuilds()
+{
+    if(! chordBuilds.FromState(apvts.state.getProperty(CHORDBUILDS_ID).toString().toStdString()))
+    {
+        chordBuilds = ChordBuilds::CreateDefault();
+        apvts.state.setProperty(CHORDBUILDS_ID, juce::String(chordBuilds.ToState()), nullptr);
+    }
+}
+
+int RibbonToNotesAudioProcessor::GetRelativeNoteNumber(int progression, int selectedzone, int notenumber) const
+{
+    return ChordCompiler::GetRelativeNoteNumber(GetChordSettings(), progression, selectedzone, notenumber);
+}
+
+// parameter changes can come from any thread (e.g. host automation), so the config
+// is compiled on the message thread. During a preset load all changes end up in one update.
+void RibbonToNotesAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    if(! isCommitting.load(std::memory_order_relaxed))
+    {
+        triggerAsyncUpdate();
+    }
+}
+
+void RibbonToNotesAudioProcessor::handleAsyncUpdate()
+{
+    UpdateEngineConfig();
+}
+
+//==============================================================================
+// State version
+//==============================================================================
+void RibbonToNotesAudioProcessor::parameterValueChanged(int parameterIndex, float newValue)
+{
+    StateChanged();
+}
+
+void RibbonToNotesAudioProcessor::valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property)
+{
+    // the children are the parameters, they are counted by parameterValueChanged
+    if(tree == apvts.state)
+    {
+        StateChanged();
+    }
+}
+
+void RibbonToNotesAudioProcessor::valueTreeRedirected(juce::ValueTree& tree)
+{
+    StateChanged(); // replaceState
+}
+
 //==============================================================================
 // Utility functions
 //==============================================================================
 void RibbonToNotesAudioProcessor::UpdateParameter(int value, juce::String parameterID)
 {
     auto pParam = apvts.getParameter(parameterID);
-    pParam->beginChangeGesture();
-    pParam->setValueNotifyingHost(pParam->convertTo0to1(value));
-    pParam->endChangeGesture();
+    SetParameterValue(*pParam, pParam->convertTo0to1((float) value));
+}
+
+void RibbonToNotesAudioProcessor::SetParameterValue(juce::RangedAudioParameter& parameter, float normalisedValue)
+{
+    if(transactionDepth > 0)
+    {
+        for(auto& change : transactionChanges)
+        {
+            if(change.parameter == &parameter)
+            {
+                change.normalisedValue = normalisedValue;
+                return;
+            }
+        }
+        transactionChanges.push_back({&parameter, apvts.getRawParameterValue(parameter.paramID), normalisedValue});
+        return;
+    }
+    parameter.beginChangeGesture();
+    parameter.setValueNotifyingHost(normalisedValue);
+    parameter.endChangeGesture();
 }
 
-bool RibbonToNotesAudioProcessor::HasChanged(int ccval)
+void RibbonToNotesAudioProcessor::commitTransaction()
 {
-    int zoneUpper = (int) *splitValues[activeZone];
-    int zoneLower = activeZone > 0 ? (int) *splitValues[activeZone-1] : 0;
-    return ccval > zoneUpper || ccval < zoneLower;
+    jassert(transactionDepth > 0);
+    if(transactionDepth == 0 || --transactionDepth > 0)
+    {
+        return;
+    }
+    bool hasChanged = chordBuildsChanged;
+    isCommitting = true;
+    for(const auto& change : transactionChanges)
+    {
+        if(change.value != nullptr && change.value->load() == change.parameter->convertFrom0to1(change.normalisedValue))
+        {
+            continue;
+        }
+        change.parameter->beginChangeGesture();
+        change.parameter->setValueNotifyingHost(change.normalisedValue);
+        change.parameter->endChangeGesture();
+        hasChanged = true;
+    }
+    transactionChanges.clear();
+    if(chordBuildsChanged)
+    {
+        chordBuildsChanged = false;
+        apvts.state.setProperty(CHORDBUILDS_ID, juce::String(chordBuilds.ToState()), nullptr);
+    }
+    isCommitting = false;
+    if(hasChanged)
+    {
+        UpdateEngineConfig();
+    }
 }
@@ -10,64 +10,20 @@
 
 #include <JuceHeader.h>
 #include "AtomicMidiInfo.h"
+#include "Engine/BinaryState.h"
+#include "Engine/EngineDefines.h"
+#include "Engine/EngineParameters.h"
+#include "Engine/ChordCompiler.h"
+#include "Engine/EngineConfig.h"
+#include "Engine/PresetBank.h"
+#include "Engine/SnapshotExchange.h"
+#include "Engine/RibbonEngine.h"
+#include "Engine/RealtimeAudit.h"
+#include "Engine/StartupProfile.h"
 #include "Service/PresetManager.h"
 
 #define DEFCONCAT(first, second) first second
 
-const int NONOTE = -128;
-
-#define MAX_PROGRESSIONS 6
-#define MAX_PROGRESSIONSKNOBS MAX_PROGRESSIONS+2
-#define MAX_NOTES 12
-#define MAX_ZONES 8
-#define MAX_SPLITS MAX_ZONES+1
-#define DEFAULT_NUMBEROFZONES 6
-
-#define MIDICC_ID "midicc"
-#define MIDICC_NAME "midi cc"
-#define NUMBEROFZONES_ID "numberofzones"
-#define NUMBEROFZONES_NAME "Number of zones"
-#define VELOCITY_ID "velocity"
-#define VELOCITY_NAME "Velocity"
-#define OCTAVES_ID "octaves"
-#define OCTAVES_NAME "Octaves"
-
-#define TOGGLEMIDI_NAME "Show midi controls"
-#define TOGGLEMIDILEARN_NAME "Midi learn"
-
-#define CHANNELIN_ID "channelin"
-#define CHANNELIN_NAME "Channel in"
-#define CHANNELOUT_ID "channelout"
-#define CHANNELOUT_NAME "Channel out"
-#define PITCHMODES_ID "pitchmodes"
-#define PITCHMODES_NAME "Pitch modes"
-#define ACTIVEPROGRESSION_ID "activeprogression"
-#define ACTIVEPROGRESSION_NAME "Active progression"
-#define KEYS_ID "keys"
-#define KEYS_NAME "Keys"
-#define CHORDS_ID "chords"
-#define CHORDS_NAME "Chords"
-#define CHORDBUILDS_ID "chordbuilds"
-#define CHORDBUILDS_NAME "ChordBuilds"
-#define NOTESTOPLAY_ID "notestoplay"
-#define NOTESTOPLAY_NAME "Notes to play"
-#define SPLITS_ID "splits"
-#define SPLITS_NAME "Splits"
-
-#define MIDIINMESSAGETYPE_ID "midiInMessageType"
-#define MIDIINMESSAGETYPE_NAME "midiInMessageType"
-#define MIDIINCHANNEL_ID "midiInChannel"
-#define MIDIINCHANNEL_NAME "midiInChannel"
-#define MIDIINNUMBER_ID "midiInNumber"
-#define MIDIINNUMBER_NAME "midiInNumber"
-#define MIDIINMINVALUE_ID "midiInMinValue"
-#define MIDIINMINVALUE_NAME "midiInMinValue"
-#define MIDIINMAXVALUE_ID "midiInMaxValue"
-#define MIDIINMAXVALUE_NAME "midiInMaxValue"
-
-#define PROGRESSION "Progression"
-
-const int defaultNoteOrder[MAX_NOTES] = {1,3,5,6,8,10,12,1,3,5,6,8};
 const juce::StringArray keysArray({"C","C#/Db","D","D#/Eb","E","F","F#/Gb","G","G#/Ab","A","A#/Bb","B"});
 const juce::StringArray chordsArray({"None","Power","Major","Minor","Dominant 7","Minor 7","Major 7","Diminished", "Octave up", "Octave down", "Custom"});
 const juce::StringArray chordbuildsArray({"empty","0","0,7","0,4,7","0,3,7","0,4,7,10","0,3,7,10","0,4,7,11","0,3,6", "0,12", "0,-12"});
@@ -93,14 +49,22 @@ const juce::StringArray midiValueArray({"0", "1", "2", "3", "4", "5", "6", "7",
     "120", "121", "122", "123", "124", "125", "126", "127"});
 
 const int DelayTimeMS = 80;
+const int MidiThruBufferSize = 4096;
+const int MidiLearnFifoSize = 256;
 
 //==============================================================================
 /**
  */
-class RibbonToNotesAudioProcessor  : public juce::AudioProcessor
+class RibbonToNotesAudioProcessor  : private StartupProfile::Stopwatch // first, see StartupProfile.h
+, public juce::AudioProcessor
 #if JucePlugin_Enable_ARA
 , public juce::AudioProcessorARAExtension
 #endif
+, private juce::AudioProcessorValueTreeState::Listener
+, private juce::AudioProcessorParameter::Listener
+, private juce::ValueTree::Listener
+, private juce::AsyncUpdater
+, private juce::Timer
 {
 public:
     //==============================================================================
@@ -115,11 +79,12 @@ public:
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 #endif
     
-    bool PlayMidi(int &ccval, int &channel, const juce::MidiMessage &message);
+    void PlayMidi(const juce::MidiMessage &message, int samplePosition);
     
-    void LearnMidi(const juce::MidiMessage &message);
+    void LearnMidi(const juce::MidiMessage &message, int samplePosition);
     
 void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
     
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -143,20 +108,43 @@ void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
     //==============================================================================
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
+    // changes with every parameter and state change. getStateInformation only writes the state again when it changed.
+    std::uint64_t GetStateVersion() const { return stateVersion.load(std::memory_order_acquire); }
     //==============================================================================
     double startTime;
-    int lastCCValue;
-    int lastChannel;
+    // midi received while midi learn is on. Message thread, filled by ReadMidiLearnMessages.
     juce::MidiBuffer midiLearnBuffer;
+    void ReadMidiLearnMessages();
 
     void PlayNextMidiMessages(juce::MidiBuffer &midiMessages,
                       const int startSample,
                       const int numSamples);
     void AddNotesToPlayToBuffer(int ccval);
-    void AddNotesToPlayToBuffer(int ccval, int channel, juce::MidiBuffer &midiMessages);
-    void AddSentAllNotesOff(juce::MidiBuffer& processedMidi, int channel);
-    void AddPreviousNotesSentNotesOff(juce::MidiBuffer& processedMidi, int channel);
-    void AddSentNotesOn(juce::MidiBuffer& processedMidi, int selectedAlt, int selectedZone, int channel);
+    std::uint8_t GetNoteVelocity() const;
+    int GetNoteOffset() const;
+    std::uint32_t getMidiQueueOverflowCount() const { return ribbonEngine.GetOverflowCount(); }
+
+    //==============================================================================
+    // Delivery of the generated midi to the host
+    //==============================================================================
+    static DeliveryPolicy GetDefaultDeliveryPolicy();
+    void SetDeliveryPolicy(const DeliveryPolicy& policy);
+    DeliveryPolicy GetDeliveryPolicy() const { return deliveryPolicy; }
+    // largest delay the delivery policy can give an event of a chord change at the prepared block size, in samples.
+    // The measured delay (getMaxDeliveryLatency) never gets larger.
+    int getDeliveryLatency() const { return DeliveryScheduler::getLatencySamples(deliveryPolicy, preparedSamplesPerBlock.load(std::memory_order_relaxed)); }
+    // largest delay an event got from the delivery policy since the last reset, in samples
+    int getMaxDeliveryLatency() const { return maxDeliveryLatency.load(std::memory_order_relaxed); }
+    void resetMaxDeliveryLatency() { maxDeliveryLatency.store(0, std::memory_order_relaxed); }
+
+    //==============================================================================
+    // Preset bank: program change n selects the n-th preset (see Engine/PresetBank.h)
+    //==============================================================================
+    void SetPresetBankSettings(const PresetBankSettings& settings);
+    PresetBankSettings GetPresetBankSettings() const { return presetBankSettings; }
+    // the next cc or note that comes in steps to the next (or previous) preset of the bank
+    void LearnPresetControl(bool next) { learnPresetControl.store(next ? 1 : 2); }
+    bool IsLearningPresetControl() const { return learnPresetControl.load() != 0; }
 
     //==============================================================================
     // Select progression
@@ -168,34 +156,69 @@ void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
     //==============================================================================
     // Utility functions
     //==============================================================================
-//    void BuildChordsForAllProgressions();
-//    void BuildChords(int alternative);
-//    void GetNoteNumbersForChord(int addOctaves, int progression, int zone, int note);
+    void UpdateEngineConfig();
+    EngineSettings GetEngineSettings() const;
+    ChordSettings GetChordSettings() const;
+    int GetRelativeNoteNumber(int progression, int selectedzone, int notenumber) const;
+    // sets the parameter with a gesture, or collects it when a transaction is open
     void UpdateParameter(int value, juce::String parameterID);
-    bool HasChanged(int ccval);
+    void SetParameterValue(juce::RangedAudioParameter& parameter, float normalisedValue);
+
+    //==============================================================================
+    // Parameter transactions, message thread only
+    //==============================================================================
+    // Between beginTransaction and commitTransaction, UpdateParameter, SetParameterValue and SetChordBuild only collect
+    // their changes, e.g. when a progression is transposed zone by zone. A parameter that is set more
+    // than once gets its last value, and a parameter that already has its value is skipped. The commit
+    // sets every changed parameter with one gesture, so the host, the editor and the listeners hear
+    // about each of them once, writes the chord builds once and compiles the engine config once.
+    // Transactions can be nested, the outermost commit sets the changes.
+    void beginTransaction() { transactionDepth++; }
+    void commitTransaction();
+    // a transaction that is committed when it goes out of scope
+    class ScopedTransaction
+    {
+    public:
+        explicit ScopedTransaction(RibbonToNotesAudioProcessor& p) : processor(p) { processor.beginTransaction(); }
+        ~ScopedTransaction() { processor.commitTransaction(); }
+    private:
+        RibbonToNotesAudioProcessor& processor;
+        JUCE_DECLARE_NON_COPYABLE(ScopedTransaction)
+    };
+
+    //==============================================================================
+    // Chord builds, message thread only
+    //==============================================================================
+    int GetChordNote(int progression, int zone, int note) const { return chordBuilds.Get(progression, zone, note); }
+    void SetChordBuild(int progression, int zone, const int* intervals);
     
 
     std::atomic<float>* midiCC = nullptr;
     std::atomic<float>* numberOfZones = nullptr;
     std::atomic<float>* noteVelocity = nullptr;
     std::atomic<float>* octaves = nullptr;
+    std::atomic<float>* hysteresis = nullptr;
+    std::atomic<float>* minimumDwell = nullptr;
+    std::atomic<float>* legato = nullptr;
+    std::atomic<float>* noteOffStyle = nullptr;
     std::atomic<float>* channelIn = nullptr;
     std::atomic<float>* channelOut = nullptr;
     std::atomic<float>* pitchMode = nullptr;
     std::atomic<float>* activeProgression = nullptr;
+    std::atomic<float>* transpose = nullptr;
+    std::atomic<float>* octaveShift = nullptr;
     std::atomic<float>* splitValues[MAX_SPLITS];
     std::atomic<float>* selectedKeys[MAX_PROGRESSIONS][MAX_ZONES];
     std::atomic<float>* selectedChord[MAX_PROGRESSIONS][MAX_ZONES];
-    std::atomic<float>* chordNotes[MAX_PROGRESSIONS][MAX_ZONES][MAX_NOTES];
-
-    std::atomic<float>* notesToPlay[MAX_PROGRESSIONS][MAX_ZONES][MAX_NOTES];
 
     AtomicMidiInfo midiInProgression[MAX_PROGRESSIONSKNOBS];
     AtomicMidiInfo midiInVelocity;
+    AtomicMidiInfo midiInTranspose;
+    AtomicMidiInfo midiInOctaveShift;
 
     
-    juce::Array<int> notesPressed;
-    int notePressedChannel[MAX_ZONES];
+    std::atomic<bool> stopNotesRequested {false};
+    bool wasPlaying = false;
     int getActiveZone() const;
     int getActiveProgression() const;
     int activeProgressionKnob;
@@ -206,10 +229,133 @@ void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
     
 private:
+    //==============================================================================
+    // recompile the engine config when one of the settings it depends on changes
+    //==============================================================================
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+    juce::StringArray configParameterIDs;
+    void ReadChordBuilds();
+    ChordBuilds chordBuilds; // copy of the CHORDBUILDS_ID property of the state
+
+    // the changes of the open transaction
+    struct ParameterChange
+    {
+        juce::RangedAudioParameter* parameter;
+        std::atomic<float>* value; // raw value, compared at commit
+        float normalisedValue;
+    };
+    std::vector<ParameterChange> transactionChanges;
+    int transactionDepth = 0;
+    bool chordBuildsChanged = false;
+    std::atomic<bool> isCommitting {false}; // the config is compiled once at the end of the commit
+
+    //==============================================================================
+    // plugin state, see Engine/BinaryState.h
+    //==============================================================================
+    struct StateParameter
+    {
+        std::uint32_t idHash;
+        juce::RangedAudioParameter* parameter;
+        std::atomic<float>* value;
+    };
+    std::vector<StateParameter> stateParameters; // all parameters, sorted by idHash
+    const StateParameter* FindStateParameter(std::uint32_t idHash) const;
+    std::atomic<float>* GetRawValue(const char* parameterID) const; // bound in the constructor, by the hash of the id
+    void ReadBinaryState(const BinaryState& state);
+    bool ReadXmlState(const void* data, int sizeInBytes); // states of older versions
+
+    // the state version is raised by every parameter (any thread) and by every property of the state
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int, bool) override {}
+    void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
+    void valueTreeRedirected(juce::ValueTree& tree) override;
+    void StateChanged() { stateVersion.fetch_add(1, std::memory_order_acq_rel); }
+    std::atomic<std::uint64_t> stateVersion {1};
+    juce::CriticalSection savedStateLock;
+    juce::MemoryBlock savedState; // written by getStateInformation for savedStateVersion
+    std::uint64_t savedStateVersion = 0;
+    SnapshotExchange<EngineConfig> engineConfigs;
+    const EngineConfig* config = nullptr; // config used by the audio thread for the current block
+
+    //==============================================================================
+    // presets loaded in the background (PresetManager::loadPreset). The config of the
+    // preset is compiled on the loading thread and published right before its
+    // parameters are set, so the audio thread switches to it at a block boundary.
+    //==============================================================================
+    void PreparePreset(const juce::ValueTree& state, int request); // loading thread
+    void PublishPreparedPreset(int request);
+    void BeginEngineBlock(); // audio thread
+    juce::CriticalSection preparedPresetLock;
+    std::unique_ptr<EngineConfig> preparedPreset;
+    int preparedPresetRequest = 0; // the PresetManager request of preparedPreset
+    EngineConfig::Preset configPreset; // preset of the configs that are published, message thread
+    std::atomic<std::uint32_t> appliedPresetSerial {0}; // preset whose parameters are set
+    std::uint32_t lastPresetSerial = 0;
+    static void CompilePreset(const juce::ValueTree& state, EngineConfig& presetConfig);
+
+    //==============================================================================
+    // preset bank. The presets are compiled on the loading thread, the audio thread
+    // switches to one of them at the sample of the program change. The parameters
+    // of the preset are set afterwards on the message thread (timerCallback).
+    //==============================================================================
+    void timerCallback() override;
+    void UpdatePresetBank();
+    void PrepareBank(const juce::Array<juce::ValueTree>& states); // loading thread
+    void PublishBank(const juce::StringArray& presetNames, const juce::Array<juce::ValueTree>& states);
+    bool SelectBankPreset(const juce::MidiMessage& message, int samplePosition); // audio thread
+    void ApplyBankPreset(int program, std::uint32_t selection);
+    PresetBankSettings presetBankSettings; // message thread copy
+    SnapshotExchange<PresetBankSettings> presetBankSettingsExchange;
+    std::shared_ptr<PresetBank> preparedBank; // guarded by preparedPresetLock
+    std::shared_ptr<const PresetBank> presetBank; // the published bank, message thread
+    juce::StringArray presetBankNames;
+    juce::Array<juce::ValueTree> presetBankStates;
+    SnapshotExchange<std::shared_ptr<const PresetBank>> presetBanks;
+    const EngineConfig::Preset* applyingBankPreset = nullptr;
+    // audio thread
+    const PresetBank* bank = nullptr;
+    const PresetBankSettings* bankSettings = nullptr;
+    const EngineConfig* bankConfig = nullptr; // selected preset, until its parameters are set
+    std::uint32_t bankSelections = 0;
+    // audio thread -> message thread
+    std::atomic<int> bankProgram {-1}; // current preset of the bank, also set by the message thread
+    std::atomic<std::uint32_t> bankSelection {0};
+    std::atomic<std::uint32_t> appliedBankSelection {0};
+    std::atomic<int> learnPresetControl {0}; // 1 next, 2 previous
+    std::atomic<int> learnedPresetControl {0}; // target | message type << 4 | channel << 8 | number << 16
+
     std::unique_ptr<Service::PresetManager> presetManager;
-    int activeZone = 0;
+    RibbonEngine ribbonEngine; // owned by the audio thread
+    std::atomic<int> activeZone {0}; // copy of the active zone of the engine for the editor
     int midiPosition;
-    juce::MidiBuffer notesToPlayBuffer;
+    juce::MidiBuffer thruMessages; // incoming midi that is not used by the plugin, passed on at its own sample position
+    std::atomic<int> requestedCCValue {-1}; // set by the editor, handled on the audio thread
+
+    //==============================================================================
+    // audio thread -> message thread, without allocating on the audio thread
+    //==============================================================================
+    // midi received while midi learn is on
+    struct LearnMessage
+    {
+        juce::uint8 data[3];
+        int size;
+        double time;
+    };
+    juce::AbstractFifo midiLearnFifo {MidiLearnFifoSize};
+    std::array<LearnMessage, MidiLearnFifoSize> midiLearnMessages;
+    // values selected by a learned control. The audio thread uses them right away, the
+    // parameter is set by the message thread (timerCallback)
+    static constexpr int NoLearnedValue = std::numeric_limits<int>::min();
+    std::atomic<int> learnedProgression {NoLearnedValue};
+    std::atomic<int> learnedTranspose {NoLearnedValue};
+    std::atomic<int> learnedOctaveShift {NoLearnedValue};
+    void ApplyLearnedValue(std::atomic<int>& learnedValue, const char* parameterID);
+
+    DeliveryPolicy deliveryPolicy; // message thread copy
+    SnapshotExchange<DeliveryPolicy> deliveryPolicies;
+    std::atomic<int> maxDeliveryLatency {0};
+    std::atomic<int> preparedSamplesPerBlock {512};
     int previousSampleNumber = 0;
 
 
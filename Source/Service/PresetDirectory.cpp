@@ -0,0 +1,260 @@
+/*
+ ==============================================================================
+
+ PresetDirectory.cpp
+ Created: 18 Oct 2026 2:41:17pm
+ Author:  PJP
+
+ ==============================================================================
+ */
+
+#include "PresetDirectory.h"
+#include "PresetManager.h"
+
+#if JUCE_LINUX
+ #include <poll.h>
+ #include <sys/inotify.h>
+ #include <unistd.h>
+#elif JUCE_MAC
+ #include <fcntl.h>
+ #include <sys/event.h>
+ #include <unistd.h>
+#elif JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#endif
+
+namespace Service
+{
+//==============================================================================
+// waits for changes of the directory on its own thread. Does nothing where the
+// OS can not watch the directory, the PresetDirectory polls it then.
+//==============================================================================
+class PresetDirectory::Watcher : public Thread
+{
+public:
+    Watcher(const File& directory, std::function<void()> onChange) : Thread("Preset directory"), changed(std::move(onChange))
+    {
+        const auto path = directory.getFullPathName();
+       #if JUCE_LINUX
+        notifications = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(notifications >= 0 && inotify_add_watch(notifications, path.toRawUTF8(),
+                                                   IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE) < 0)
+        {
+            close(notifications);
+            notifications = -1;
+        }
+        isWatching = notifications >= 0;
+       #elif JUCE_MAC
+        // only changes of the entries of the directory, not of a file that is rewritten in place
+        queue = kqueue();
+        directoryHandle = open(path.toRawUTF8(), O_EVTONLY);
+        if(queue >= 0 && directoryHandle >= 0)
+        {
+            struct kevent change;
+            EV_SET(&change, directoryHandle, EVFILT_VNODE, EV_ADD | EV_CLEAR, NOTE_WRITE | NOTE_DELETE | NOTE_RENAME, 0, nullptr);
+            isWatching = kevent(queue, &change, 1, nullptr, 0, nullptr) == 0;
+        }
+       #elif JUCE_WINDOWS
+        notifications = FindFirstChangeNotificationW(path.toWideCharPointer(), FALSE,
+                                                     FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+        isWatching = notifications != INVALID_HANDLE_VALUE;
+       #endif
+        if(isWatching)
+            startThread();
+    }
+    ~Watcher() override
+    {
+        stopThread(2000);
+       #if JUCE_LINUX
+        if(notifications >= 0)
+            close(notifications);
+       #elif JUCE_MAC
+        if(directoryHandle >= 0)
+            close(directoryHandle);
+        if(queue >= 0)
+            close(queue);
+       #elif JUCE_WINDOWS
+        if(notifications != INVALID_HANDLE_VALUE)
+            FindCloseChangeNotification(notifications);
+       #endif
+    }
+
+    std::atomic<bool> isWatching {false};
+
+private:
+    // waits at most half a second, so the thread can be stopped
+    void run() override
+    {
+        while(! threadShouldExit())
+        {
+           #if JUCE_LINUX
+            pollfd events {notifications, POLLIN, 0};
+            if(poll(&events, 1, 500) > 0)
+            {
+                char buffer[4096];
+                while(read(notifications, buffer, sizeof(buffer)) > 0) {}
+                changed();
+            }
+           #elif JUCE_MAC
+            const timespec timeout {0, 500000000};
+            struct kevent event;
+            if(kevent(queue, nullptr, 0, &event, 1, &timeout) > 0)
+                changed();
+           #elif JUCE_WINDOWS
+            if(WaitForSingleObject(notifications, 500) == WAIT_OBJECT_0)
+            {
+                // without the next notification the directory is polled
+                if(! FindNextChangeNotification(notifications))
+                    isWatching = false;
+                changed();
+                if(! isWatching)
+                    return;
+            }
+           #else
+            return;
+           #endif
+        }
+    }
+
+    std::function<void()> changed;
+   #if JUCE_LINUX
+    int notifications = -1;
+   #elif JUCE_MAC
+    int queue = -1;
+    int directoryHandle = -1;
+   #elif JUCE_WINDOWS
+    HANDLE notifications = INVALID_HANDLE_VALUE;
+   #endif
+};
+
+//==============================================================================
+PresetDirectory::PresetDirectory()
+{
+    const auto& directory = PresetManager::defaultDirectory;
+    if(!directory.exists())
+    {
+        const auto result = directory.createDirectory();
+        if(result.failed())
+        {
+            DBG("Could not create preset directory:" + result.getErrorMessage());
+            jassertfalse;
+        }
+    }
+    watcher = std::make_unique<Watcher>(directory, [this]
+    {
+        directoryChanged = true;
+        triggerAsyncUpdate();
+    });
+    scan();
+}
+
+PresetDirectory::~PresetDirectory()
+{
+    watcher = nullptr;
+    stopTimer();
+    indexThread.removeAllJobs(true, 2000);
+    cancelPendingUpdate();
+}
+
+void PresetDirectory::add(const std::vector<PresetIndex::PresetInfo>& presets)
+{
+    for(const auto& preset : presets)
+        presetIndex.add(preset);
+    indexChanges++;
+    indexChanged();
+}
+void PresetDirectory::remove(const String& presetName)
+{
+    presetIndex.remove(presetName);
+    indexChanges++;
+    indexChanged();
+}
+void PresetDirectory::indexChanged()
+{
+    version++;
+    listeners.call([](Listener& listener) { listener.presetIndexChanged(); });
+}
+
+bool PresetDirectory::isWatching() const
+{
+    return watcher != nullptr && watcher->isWatching;
+}
+
+//==============================================================================
+void PresetDirectory::timerCallback()
+{
+    stopTimer();
+    scan();
+}
+void PresetDirectory::scanSoon()
+{
+    scanInterval = minScanInterval;
+    if(isScanning)
+        rescanRequested = true;
+    else
+        startTimer(changeDelay);
+}
+void PresetDirectory::scan()
+{
+    isScanning = true;
+    indexThread.addJob([this, previous = presetIndex.getPresets(), changes = indexChanges]
+    {
+        auto found = PresetIndex::scan(PresetManager::defaultDirectory, PresetManager::extension, PresetManager::bankExtension, previous);
+        const auto isUnchanged = std::equal(found.begin(), found.end(), previous.begin(), previous.end(),
+            [](const PresetIndex::PresetInfo& first, const PresetIndex::PresetInfo& second)
+            {
+                return first.name == second.name && first.modified == second.modified && first.size == second.size;
+            });
+        {
+            const ScopedLock lock(scannedLock);
+            if(! isUnchanged)
+                scannedPresets = std::move(found);
+            scanFoundChanges = ! isUnchanged;
+            scannedIndexChanges = changes;
+            scanIsDone = true;
+        }
+        triggerAsyncUpdate();
+    });
+}
+void PresetDirectory::handleAsyncUpdate()
+{
+    bool isDone;
+    bool foundChanges = false;
+    std::vector<PresetIndex::PresetInfo> found;
+    int changes = 0;
+    {
+        const ScopedLock lock(scannedLock);
+        isDone = scanIsDone;
+        if(isDone)
+        {
+            foundChanges = scanFoundChanges;
+            found = std::move(scannedPresets);
+            changes = scannedIndexChanges;
+        }
+        scanIsDone = false;
+        scannedPresets.clear();
+    }
+    if(isDone)
+    {
+        isScanning = false;
+        // a scan that started before a preset was saved or deleted does not know about it
+        if(foundChanges && changes == indexChanges)
+        {
+            presetIndex.setPresets(std::move(found));
+            indexChanged();
+        }
+        // a watched directory is scanned when it changes. Otherwise it is polled, and the interval grows while nothing changes.
+        scanInterval = foundChanges ? minScanInterval : jmin(scanInterval * 2, maxScanInterval);
+        if(rescanRequested)
+            startTimer(changeDelay);
+        else if(! isWatching())
+            startTimer(scanInterval);
+        rescanRequested = false;
+    }
+    if(directoryChanged.exchange(false))
+        scanSoon();
+}
+}
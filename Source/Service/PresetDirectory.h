@@ -0,0 +1,84 @@
+/*
+ ==============================================================================
+
+ PresetDirectory.h
+ Created: 18 Oct 2026 2:41:17pm
+ Author:  PJP
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PresetIndex.h"
+
+namespace Service
+{
+using namespace juce;
+
+//==============================================================================
+// The preset directory and its index, shared by all instances of the plugin in
+// the process (SharedResourcePointer), so a session with many instances reads
+// the directory once. Where the OS can watch a directory (inotify, kqueue,
+// change notifications on Windows) it is only scanned when it changes. Only
+// when no watch could be started, the directory is polled, with an interval
+// that grows while nothing changes. A file that is rewritten in place on
+// macOS is not seen by the watch; it is found with the next change of the
+// directory.
+// Message thread only.
+//==============================================================================
+class PresetDirectory : private AsyncUpdater, private Timer
+{
+public:
+    PresetDirectory();
+    ~PresetDirectory() override;
+
+    struct Listener
+    {
+        virtual ~Listener() = default;
+        // the presets changed, in the directory or by one of the instances
+        virtual void presetIndexChanged() = 0;
+    };
+    void addListener(Listener* listener) { listeners.add(listener); }
+    void removeListener(Listener* listener) { listeners.remove(listener); }
+
+    const PresetIndex& getIndex() const { return presetIndex; }
+    // changes when presets are added, removed or changed
+    int getVersion() const { return version; }
+    // preset files written or deleted by an instance, without waiting for a scan
+    void add(const std::vector<PresetIndex::PresetInfo>& presets);
+    void remove(const String& presetName);
+
+private:
+    class Watcher;
+    void handleAsyncUpdate() override;
+    void timerCallback() override;
+    void scan();
+    void scanSoon();
+    void indexChanged();
+    bool isWatching() const;
+
+    PresetIndex presetIndex;
+    int version = 0;
+    int indexChanges = 0; // changes made by add and remove, a scan that started before one is dropped
+    ListenerList<Listener> listeners;
+
+    static constexpr int minScanInterval = 3000;
+    static constexpr int maxScanInterval = 60000;
+    static constexpr int changeDelay = 250; // a file is often written in several steps
+    ThreadPool indexThread {1};
+    int scanInterval = minScanInterval;
+    bool isScanning = false; // one scan at a time, a slow (network) directory is not scanned again before it is done
+    bool rescanRequested = false;
+
+    CriticalSection scannedLock;
+    bool scanIsDone = false;
+    bool scanFoundChanges = false;
+    std::vector<PresetIndex::PresetInfo> scannedPresets;
+    int scannedIndexChanges = 0;
+
+    std::atomic<bool> directoryChanged {false}; // set by the watcher
+    std::unique_ptr<Watcher> watcher;
+};
+}
@@ -0,0 +1,154 @@
+/*
+ ==============================================================================
+
+ PresetIndex.cpp
+ Created: 18 Oct 2026 9:12:44am
+ Author:  PJP
+
+ ==============================================================================
+ */
+
+#include "PresetIndex.h"
+#include "../Engine/PresetBankFile.h"
+
+namespace Service
+{
+// the order of StringArray::sort(true), with names that only differ in case in a fixed order
+bool PresetIndex::isBefore(const String& first, const String& second)
+{
+    const auto result = first.compareIgnoreCase(second);
+    return result != 0 ? result < 0 : first.compare(second) < 0;
+}
+std::vector<PresetIndex::PresetInfo>::const_iterator PresetIndex::lowerBound(const String& presetName) const
+{
+    return std::lower_bound(presets.begin(), presets.end(), presetName,
+                            [](const PresetInfo& info, const String& name) { return isBefore(info.name, name); });
+}
+int PresetIndex::indexOf(const String& presetName) const
+{
+    const auto found = lowerBound(presetName);
+    if(found == presets.end() || found->name != presetName)
+        return -1;
+    return (int) std::distance(presets.begin(), found);
+}
+StringArray PresetIndex::findPresets(const String& text) const
+{
+    // names that start with the text are next to each other
+    StringArray found;
+    for(auto preset = lowerBound(text); preset != presets.end() && preset->name.startsWithIgnoreCase(text); ++preset)
+    {
+        found.add(preset->name);
+    }
+    return found;
+}
+void PresetIndex::add(PresetInfo info)
+{
+    const auto position = lowerBound(info.name);
+    const auto index = (int) std::distance(presets.cbegin(), position);
+    if(position != presets.end() && position->name == info.name && position->bankRecord == info.bankRecord)
+    {
+        presets[(size_t) index] = std::move(info);
+        return;
+    }
+    names.insert(index, info.name);
+    presets.insert(position, std::move(info));
+}
+void PresetIndex::remove(const String& presetName)
+{
+    const auto index = indexOf(presetName);
+    if(index < 0 || presets[(size_t) index].bankRecord >= 0)
+        return;
+    presets.erase(presets.begin() + index);
+    names.remove(index);
+}
+void PresetIndex::setPresets(std::vector<PresetInfo> newPresets)
+{
+    presets = std::move(newPresets);
+    names.clearQuick();
+    names.ensureStorageAllocated((int) presets.size());
+    for(const auto& preset : presets)
+    {
+        names.add(preset.name);
+    }
+}
+PresetIndex::PresetInfo PresetIndex::readInfo(const File& file)
+{
+    PresetInfo info;
+    info.name = file.getFileNameWithoutExtension();
+    info.file = file;
+    info.modified = file.getLastModificationTime();
+    info.size = file.getSize();
+    // only the attributes of the state are read, not the parameters
+    XmlDocument xmlDocument(file);
+    if(const auto xml = xmlDocument.getDocumentElement(true))
+        info.version = xml->getStringAttribute("version");
+    return info;
+}
+std::vector<PresetIndex::PresetInfo> PresetIndex::readBankInfo(const File& bankFile)
+{
+    std::vector<PresetInfo> presets;
+    MemoryMappedFile mappedFile(bankFile, MemoryMappedFile::readOnly);
+    PresetBankFile bank;
+    if(! bank.Open(mappedFile.getData(), mappedFile.getSize()))
+    {
+        DBG("Preset bank " + bankFile.getFullPathName() + " could not be read");
+        return presets;
+    }
+    for(int i=0;i<bank.GetNumPresets();i++)
+    {
+        PresetInfo info;
+        const auto name = bank.GetName(i);
+        info.name = String::fromUTF8(name.data(), (int) name.size());
+        info.file = bankFile;
+        info.modified = bankFile.getLastModificationTime();
+        info.size = bankFile.getSize();
+        BinaryState state;
+        if(bank.ReadPreset(i, state))
+            info.version = String::fromUTF8(state.pluginVersion.data(), (int) state.pluginVersion.size());
+        info.bankRecord = i;
+        presets.push_back(std::move(info));
+    }
+    return presets;
+}
+std::vector<PresetIndex::PresetInfo> PresetIndex::scan(const File& directory, const String& extension, const String& bankExtension,
+                                                       const std::vector<PresetInfo>& previous)
+{
+    std::vector<PresetInfo> found;
+    for(const auto& entry : RangedDirectoryIterator(directory, false, "*." + bankExtension, File::findFiles))
+    {
+        // the presets of a bank that did not change are taken from the previous index
+        const auto& bankFile = entry.getFile();
+        std::vector<PresetInfo> known;
+        for(const auto& preset : previous)
+        {
+            if(preset.bankRecord >= 0 && preset.file == bankFile)
+                known.push_back(preset);
+        }
+        if(known.empty() || known.front().modified != entry.getModificationTime() || known.front().size != entry.getFileSize())
+            known = readBankInfo(bankFile);
+        found.insert(found.end(), known.begin(), known.end());
+    }
+    for(const auto& entry : RangedDirectoryIterator(directory, false, "*." + extension, File::findFiles))
+    {
+        const auto& file = entry.getFile();
+        const auto name = file.getFileNameWithoutExtension();
+        const auto known = std::lower_bound(previous.begin(), previous.end(), name,
+                                            [](const PresetInfo& info, const String& presetName) { return isBefore(info.name, presetName); });
+        if(known != previous.end() && known->name == name && known->bankRecord < 0
+           && known->modified == entry.getModificationTime() && known->size == entry.getFileSize())
+        {
+            found.push_back(*known);
+        }
+        else
+        {
+            found.push_back(readInfo(file));
+        }
+    }
+    // a name that is both in a preset file and in a bank is loaded from the preset file
+    std::sort(found.begin(), found.end(), [](const PresetInfo& first, const PresetInfo& second)
+    {
+        return isBefore(first.name, second.name) || (first.name == second.name && first.bankRecord < second.bankRecord);
+    });
+    return found;
+}
+}
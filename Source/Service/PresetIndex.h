@@ -0,0 +1,67 @@
+/*
+ ==============================================================================
+
+ PresetIndex.h
+ Created: 18 Oct 2026 9:12:44am
+ Author:  PJP
+
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Service
+{
+using namespace juce;
+
+//==============================================================================
+// The presets of the preset directory, sorted by name (ignoring case), with
+// what is known about their files. The presets of the bank files in the
+// directory (Engine/PresetBankFile.h) are listed like the others.
+// Lookups do not touch the disk: the index is
+// built by scan() on a background thread and kept up to date by the
+// PresetManager. Only used on the message thread, scan() excepted.
+//==============================================================================
+class PresetIndex
+{
+public:
+    struct PresetInfo
+    {
+        String name;
+        File file;
+        Time modified;
+        int64 size = 0;
+        String version; // version of the plugin that saved the preset
+        int bankRecord = -1; // record in the bank file, -1 for a preset file
+    };
+
+    int size() const { return (int) presets.size(); }
+    const PresetInfo& operator[](int index) const { return presets[(size_t) index]; }
+    // the names in index order
+    const StringArray& getNames() const { return names; }
+    // -1 when the preset is not in the index. O(log n)
+    int indexOf(const String& presetName) const;
+    // the presets whose name starts with the text (ignoring case). O(log n) plus the number found
+    StringArray findPresets(const String& text) const;
+
+    void add(PresetInfo info); // replaces a preset with the same name and place
+    void remove(const String& presetName); // presets of a bank are only removed with their bank file
+
+    // reads the directory. Presets whose file did not change since the previous index are taken
+    // from it, the others are read (only their outer element, or the index of a bank). Background thread.
+    static std::vector<PresetInfo> scan(const File& directory, const String& extension, const String& bankExtension,
+                                        const std::vector<PresetInfo>& previous);
+    static PresetInfo readInfo(const File& file);
+    static std::vector<PresetInfo> readBankInfo(const File& bankFile);
+    const std::vector<PresetInfo>& getPresets() const { return presets; }
+    void setPresets(std::vector<PresetInfo> newPresets);
+
+private:
+    static bool isBefore(const String& first, const String& second);
+    std::vector<PresetInfo>::const_iterator lowerBound(const String& presetName) const;
+    std::vector<PresetInfo> presets;
+    StringArray names; // cached for getNames, same order as presets
+};
+}
@@ -19,23 +19,39 @@ const File PresetManager::defaultDirectory
         .getChildFile(ProjectInfo::projectName)
 };
 const String PresetManager::extension{"preset"};
+const String PresetManager::bankExtension{"presetbank"};
 const String PresetManager::presetNameProperty{"presetName"};
 
 PresetManager::PresetManager(AudioProcessorValueTreeState& apvts) : valueTreeState(apvts)
 {
-    if(!defaultDirectory.exists())
-    {
-        const auto result = defaultDirectory.createDirectory();
-        if(result.failed())
-        {
-            DBG("Could not create preset directory:" + result.getErrorMessage());
-            jassertfalse;
-        }
-    }
+    // the preset directory is created by the PresetDirectory
+    presetDirectory->addListener(this);
     //make sure that the currentPreset reference is updated via the listener when the valueTree changes.
     valueTreeState.state.addListener(this);
     //let currentPreset Value object point to the samen name as the presetNameProperty of the valueTree.
     currentPreset.referTo(valueTreeState.state.getPropertyAsValue(presetNameProperty, nullptr));
+    // bank files store the parameters by the hash of their id, like the plugin state
+    stateType = valueTreeState.state.getType();
+    const auto& parameters = valueTreeState.processor.getParameters();
+    rawValues.resize((size_t) parameters.size(), nullptr);
+    for(auto* parameter : parameters)
+    {
+        if(auto* ranged = dynamic_cast<RangedAudioParameter*>(parameter))
+        {
+            parameterIDs[BinaryState::HashID(ranged->paramID.toRawUTF8())] = ranged->paramID;
+            rawValues[(size_t) ranged->getParameterIndex()] = valueTreeState.getRawParameterValue(ranged->paramID);
+        }
+    }
+}
+
+PresetManager::~PresetManager()
+{
+    presetDirectory->removeListener(this);
+    latestRequest = -1;
+    latestBankRequest = -1;
+    loadingThread.removeAllJobs(true, 2000);
+    cancelPendingUpdate();
+    valueTreeState.state.removeListener(this);
 }
 
 void PresetManager::savePreset(const String& presetName)
@@ -50,12 +66,20 @@ void PresetManager::savePreset(const String& presetName)
     {
         DBG("Could not create preset file:" + presetFile.getFullPathName());
         jassertfalse;
+        return;
     }
+    presetDirectory->add({PresetIndex::readInfo(presetFile)});
 }
 void PresetManager::deletePreset(const juce::String& presetName)
 {
     if(presetName.isEmpty())
         return;
+    const auto index = presetIndex().indexOf(presetName);
+    if(index >= 0 && presetIndex()[index].bankRecord >= 0)
+    {
+        DBG("Preset " + presetName + " is part of the bank " + presetIndex()[index].file.getFullPathName());
+        return;
+    }
     
     const auto presetFile = defaultDirectory.getChildFile(presetName + "." + extension);
     if(presetFile.deleteFile()== false)
@@ -65,72 +89,377 @@ void PresetManager::deletePreset(const juce::String& presetName)
         return;
     }
     currentPreset.setValue("");
+    presetDirectory->remove(presetName);
 }
 void PresetManager::loadPreset(const juce::String& presetName)
 {
     if(presetName.isEmpty())
         return;
     
-    const auto presetFile = defaultDirectory.getChildFile(presetName + "." + extension);
-    if(presetFile.existsAsFile() == false)
+    // presets that are not in the index yet (e.g. just copied into the directory) are looked up on disk
+    const auto& index = presetIndex();
+    const auto position = index.indexOf(presetName);
+    if(position >= 0 && index[position].bankRecord >= 0)
+    {
+        // a preset of a bank is read in place, that is fast enough for the message thread
+        const auto valueTreeToLoad = readBankPreset(mappedBanks, index[position].file, index[position].bankRecord);
+        if(! valueTreeToLoad.isValid())
+        {
+            DBG("Preset " + presetName + " could not be read from " + index[position].file.getFullPathName());
+            return;
+        }
+        // a preset file that is still loading is dropped
+        const auto request = ++latestRequest;
+        requestedPreset = {};
+        if(onPresetParsed != nullptr)
+            onPresetParsed(valueTreeToLoad, request);
+        applyPreset(valueTreeToLoad, presetName, request);
+        return;
+    }
+    const auto presetFile = position >= 0 ? index[position].file : defaultDirectory.getChildFile(presetName + "." + extension);
+    if(position < 0 && presetFile.existsAsFile() == false)
     {
         DBG("Preset file " + presetFile.getFullPathName() + " does not exist");
         jassertfalse;
         return;
     }
-    //convert presetfile (XML) => (ValueTree)
-    PresetLoading = ePresetLoading::startLoading;
-    XmlDocument xmlDocument(presetFile);
-    const auto valueTreeToLoad = ValueTree::fromXml(*xmlDocument.getDocumentElement());
-    valueTreeState.replaceState(valueTreeToLoad);
-
-    for(int i = 0 ; i<valueTreeToLoad.getNumChildren();++i)
+    const auto request = ++latestRequest;
+    requestedPreset = presetName;
+    loadingThread.addJob([this, presetFile, presetName, request]
     {
-        const auto parameterChildToLoad = valueTreeToLoad.getChild(i);
-        const auto parameterId = parameterChildToLoad.getProperty("id");
-        auto parameterTree = valueTreeState.state.getChildWithProperty("id", parameterId);
-        if(parameterTree.isValid())
+        //convert presetfile (XML) => (ValueTree)
+        if(request != latestRequest.load())
+            return;
+        const auto valueTreeToLoad = readPresetFile(presetFile);
+        if(request != latestRequest.load())
+            return;
+        if(valueTreeToLoad.isValid() && onPresetParsed != nullptr)
+            onPresetParsed(valueTreeToLoad, request);
         {
-            parameterTree.copyPropertiesFrom(parameterChildToLoad, nullptr);
+            const ScopedLock lock(loadedLock);
+            loadedState = valueTreeToLoad;
+            loadedPresetName = presetName;
+            loadedRequest = request;
         }
+        triggerAsyncUpdate();
+    });
+}
+void PresetManager::loadBank(int maxPresets)
+{
+    const auto request = ++latestBankRequest;
+    const auto& allPresets = presetIndex().getPresets();
+    std::vector<PresetIndex::PresetInfo> presets(allPresets.begin(), allPresets.begin() + jmin(maxPresets, presetIndex().size()));
+    loadingThread.addJob([this, presets, maxPresets, request]
+    {
+        StringArray names;
+        Array<ValueTree> states;
+        MappedBanks banks;
+        for(const auto& preset : presets)
+        {
+            if(states.size() >= maxPresets || request != latestBankRequest.load())
+                break;
+            const auto state = preset.bankRecord < 0 ? readPresetFile(preset.file) : readBankPreset(banks, preset.file, preset.bankRecord);
+            if(state.isValid())
+            {
+                names.add(preset.name);
+                states.add(state);
+            }
+        }
+        if(request != latestBankRequest.load())
+            return;
+        if(onBankParsed != nullptr)
+            onBankParsed(states);
+        {
+            const ScopedLock lock(loadedLock);
+            loadedBankNames = names;
+            loadedBankStates = states;
+            loadedBankRequest = request;
+            bankIsLoaded = true;
+        }
+        triggerAsyncUpdate();
+    });
+}
+void PresetManager::applyBankPreset(const ValueTree& state, const String& presetName)
+{
+    // the state is only read, the bank keeps it
+    applyPreset(state, presetName, 0);
+}
+void PresetManager::handleAsyncUpdate()
+{
+    ValueTree valueTreeToLoad;
+    String presetName;
+    int request = 0;
+    bool isLatestPreset;
+    StringArray bankNames;
+    Array<ValueTree> bankStates;
+    bool isLatestBank = false;
+    {
+        const ScopedLock lock(loadedLock);
+        // a preset that was requested after this one is still loading
+        isLatestPreset = loadedRequest == latestRequest.load();
+        if(isLatestPreset)
+        {
+            valueTreeToLoad = loadedState;
+            presetName = loadedPresetName;
+            request = loadedRequest;
+            loadedState = {};
+        }
+        if(bankIsLoaded && loadedBankRequest == latestBankRequest.load())
+        {
+            bankNames = loadedBankNames;
+            bankStates = loadedBankStates;
+            isLatestBank = true;
+        }
+        bankIsLoaded = false;
+        loadedBankStates.clear();
+    }
+    if(isLatestBank && onBankLoaded != nullptr)
+        onBankLoaded(bankNames, bankStates);
+    if(isLatestPreset)
+    {
+        requestedPreset = {};
+        if(valueTreeToLoad.isValid())
+            applyPreset(valueTreeToLoad, presetName, request);
+    }
+}
+void PresetManager::applyPreset(const ValueTree& valueTreeToLoad, const String& presetName, int request)
+{
+    PresetLoading = ePresetLoading::startLoading;
+    if(onPresetApplying != nullptr)
+        onPresetApplying(request);
+
+    // the properties of the state (chord builds, version), setProperty does nothing when the value is the same
+    for(int i = 0; i < valueTreeToLoad.getNumProperties(); ++i)
+    {
+        const auto property = valueTreeToLoad.getPropertyName(i);
+        if(property != presetNameProperty)
+            valueTreeState.state.setProperty(property, valueTreeToLoad.getProperty(property), nullptr);
+    }
+
+    // one pass over the preset: only the parameters whose value differs are set, so listeners,
+    // attachments and the host only hear about what changed. They are set together by onApplyParameters,
+    // so the engine config is compiled once for all of them.
+    // The values are compared with the raw values, which the engine reads, not with the normalised
+    // value of the parameter: a raw value that was written directly would not be restored otherwise.
+    const auto isSet = [this](RangedAudioParameter& parameter, float normalisedValue)
+    {
+        const auto* rawValue = rawValues[(size_t) parameter.getParameterIndex()];
+        return rawValue != nullptr && rawValue->load() == parameter.convertFrom0to1(normalisedValue);
+    };
+    const auto& parameters = valueTreeState.processor.getParameters();
+    std::vector<bool> isInPreset((size_t) parameters.size(), false);
+    std::vector<ParameterValue> changes;
+    for(const auto& child : valueTreeToLoad)
+    {
+        auto* parameter = valueTreeState.getParameter(child.getProperty("id").toString());
+        if(parameter == nullptr)
+            continue;
+        isInPreset[(size_t) parameter->getParameterIndex()] = true;
+        const auto normalisedValue = parameter->convertTo0to1((float) child.getProperty("value"));
+        if(! isSet(*parameter, normalisedValue))
+            changes.push_back({parameter, normalisedValue});
+    }
+    // parameters that are not in the preset get their default value, like replaceState does
+    for(auto* parameter : parameters)
+    {
+        auto* ranged = dynamic_cast<RangedAudioParameter*>(parameter);
+        if(ranged != nullptr && ! isInPreset[(size_t) ranged->getParameterIndex()] && ! isSet(*ranged, ranged->getDefaultValue()))
+            changes.push_back({ranged, ranged->getDefaultValue()});
     }
+    if(onApplyParameters != nullptr)
+        onApplyParameters(changes);
+    else
+        for(const auto& change : changes)
+            change.parameter->setValueNotifyingHost(change.value);
     PresetLoading = ePresetLoading::finishLoading;
     currentPreset.setValue(presetName);
+    if(onPresetLoaded != nullptr)
+        onPresetLoaded();
 }
 int PresetManager::loadNextPreset()
 {
-    const auto allPresets = getAllPresets();
-    if(allPresets.isEmpty())
+    const auto numPresets = presetIndex().size();
+    if(numPresets == 0)
         return -1;
-    const auto currentIndex = allPresets.indexOf(currentPreset.toString());
-    const auto nextIndex = currentIndex + 1 > (allPresets.size() - 1) ? 0 : currentIndex + 1;
-    loadPreset(allPresets.getReference(nextIndex));
+    const auto currentIndex = presetIndex().indexOf(requestedPreset.isNotEmpty() ? requestedPreset : currentPreset.toString());
+    const auto nextIndex = currentIndex + 1 > (numPresets - 1) ? 0 : currentIndex + 1;
+    loadPreset(presetIndex()[nextIndex].name);
     return nextIndex;
 }
 int PresetManager::loadPreviousPreset()
 {
-    const auto allPresets = getAllPresets();
-    if(allPresets.isEmpty())
+    const auto numPresets = presetIndex().size();
+    if(numPresets == 0)
         return -1;
-    const auto currentIndex = allPresets.indexOf(currentPreset.toString());
-    const auto prevIndex = currentIndex - 1 < 0  ? allPresets.size() - 1 : currentIndex - 1;
-    loadPreset(allPresets.getReference(prevIndex));
+    const auto currentIndex = presetIndex().indexOf(requestedPreset.isNotEmpty() ? requestedPreset : currentPreset.toString());
+    const auto prevIndex = currentIndex - 1 < 0  ? numPresets - 1 : currentIndex - 1;
+    loadPreset(presetIndex()[prevIndex].name);
     return prevIndex;
 }
 juce::StringArray PresetManager::getAllPresets() const
 {
-    juce::StringArray presets;
-    const auto fileArray = defaultDirectory.findChildFiles(juce::File::TypesOfFileToFind::findFiles, false, "*."+ extension);
-    for(const auto& file : fileArray)
-    {
-        presets.add(file.getFileNameWithoutExtension());
-    }
-    return presets;
+    return presetIndex().getNames();
+}
+juce::StringArray PresetManager::findPresets(const String& text) const
+{
+    return presetIndex().findPresets(text);
+}
+void PresetManager::presetIndexChanged()
+{
+    // a bank file that changed is mapped again
+    mappedBanks.clear();
+    if(onPresetListChanged != nullptr)
+        onPresetListChanged();
 }
 juce::String PresetManager::getCurrentPreset() const
 {
     return currentPreset.toString();
 }
+//==============================================================================
+int PresetManager::exportBank(const File& bankFile)
+{
+    std::vector<PresetBankFile::Preset> presets;
+    for(const auto& preset : presetIndex().getPresets())
+    {
+        if(preset.bankRecord >= 0)
+            continue;
+        const auto state = readPresetFile(preset.file);
+        if(state.isValid())
+            presets.push_back({preset.name.toStdString(), toBinaryState(state)});
+    }
+    const auto bank = PresetBankFile::Write(presets);
+    // replaceWithData writes a new file, so a bank that is mapped stays valid
+    if(! bankFile.replaceWithData(bank.data(), bank.size()))
+    {
+        DBG("Could not create preset bank:" + bankFile.getFullPathName());
+        return -1;
+    }
+    return (int) presets.size();
+}
+int PresetManager::importBank(const File& bankFile)
+{
+    MemoryMappedFile mappedFile(bankFile, MemoryMappedFile::readOnly);
+    PresetBankFile bank;
+    if(! bank.Open(mappedFile.getData(), mappedFile.getSize()))
+        return -1;
+    std::vector<PresetIndex::PresetInfo> imported;
+    for(int i = 0; i < bank.GetNumPresets(); ++i)
+    {
+        const auto name = bank.GetName(i);
+        const auto presetName = File::createLegalFileName(String::fromUTF8(name.data(), (int) name.size()));
+        BinaryState state;
+        if(presetName.isEmpty() || ! bank.ReadPreset(i, state))
+            continue;
+        auto valueTree = fromBinaryState(state);
+        valueTree.setProperty(presetNameProperty, presetName, nullptr);
+        const auto presetFile = defaultDirectory.getChildFile(presetName + "." + extension);
+        if(! valueTree.createXml()->writeTo(presetFile))
+        {
+            DBG("Could not create preset file:" + presetFile.getFullPathName());
+            continue;
+        }
+        imported.push_back(PresetIndex::readInfo(presetFile));
+    }
+    if(! imported.empty())
+        presetDirectory->add(imported);
+    return (int) imported.size();
+}
+ValueTree PresetManager::readPresetFile(const File& presetFile)
+{
+    XmlDocument xmlDocument(presetFile);
+    const auto xml = xmlDocument.getDocumentElement();
+    if(xml == nullptr)
+    {
+        DBG("Preset file " + presetFile.getFullPathName() + " could not be read: " + xmlDocument.getLastParseError());
+        return {};
+    }
+    auto state = ValueTree::fromXml(*xml);
+    migrateState(state);
+    return state;
+}
+ValueTree PresetManager::readBankPreset(MappedBanks& banks, const File& bankFile, int record) const
+{
+    auto& mapped = banks[bankFile.getFullPathName()];
+    if(mapped.mappedFile == nullptr)
+    {
+        mapped.mappedFile = std::make_unique<MemoryMappedFile>(bankFile, MemoryMappedFile::readOnly);
+        mapped.isOpen = mapped.bank.Open(mapped.mappedFile->getData(), mapped.mappedFile->getSize());
+    }
+    BinaryState state;
+    if(! mapped.isOpen || ! mapped.bank.ReadPreset(record, state))
+        return {};
+    return fromBinaryState(state);
+}
+BinaryState PresetManager::toBinaryState(const ValueTree& state)
+{
+    BinaryState binaryState;
+    for(const auto& child : state)
+    {
+        binaryState.parameters.push_back({BinaryState::HashID(child.getProperty("id").toString().toRawUTF8()), (float) child.getProperty("value")});
+    }
+    auto chordBuilds = ChordBuilds::CreateDefault();
+    chordBuilds.FromState(state.getProperty(CHORDBUILDS_ID).toString().toStdString());
+    binaryState.chordBuilds = chordBuilds.ToBytes();
+    binaryState.presetName = state.getProperty(presetNameProperty).toString().toStdString();
+    binaryState.pluginVersion = state.getProperty("version").toString().toStdString();
+    return binaryState;
+}
+// the state as it is in a preset file. Parameters that this version does not know are left out.
+ValueTree PresetManager::fromBinaryState(const BinaryState& state) const
+{
+    ValueTree valueTree(stateType);
+    auto chordBuilds = ChordBuilds::CreateDefault();
+    chordBuilds.FromBytes(state.chordBuilds.data(), state.chordBuilds.size());
+    valueTree.setProperty(CHORDBUILDS_ID, String(chordBuilds.ToState()), nullptr);
+    valueTree.setProperty(presetNameProperty, String::fromUTF8(state.presetName.data(), (int) state.presetName.size()), nullptr);
+    valueTree.setProperty("version", String::fromUTF8(state.pluginVersion.data(), (int) state.pluginVersion.size()), nullptr);
+    for(const auto& parameter : state.parameters)
+    {
+        const auto parameterID = parameterIDs.find(parameter.idHash);
+        if(parameterID == parameterIDs.end())
+            continue;
+        ValueTree child("PARAM");
+        child.setProperty("id", parameterID->second, nullptr);
+        child.setProperty("value", parameter.value, nullptr);
+        valueTree.appendChild(child, nullptr);
+    }
+    return valueTree;
+}
+void PresetManager::migrateState(juce::ValueTree& state)
+{
+    // chord builds of older versions are parameters chordbuilds<prog>_<zone>_<note>
+    const bool hasChordBuilds = state.hasProperty(CHORDBUILDS_ID);
+    auto chordBuilds = ChordBuilds::CreateDefault();
+
+    for(int i = state.getNumChildren() - 1; i >= 0; --i)
+    {
+        const auto parameterId = state.getChild(i).getProperty("id").toString();
+        if(parameterId.startsWith(CHORDBUILDS_ID))
+        {
+            juce::StringArray indexes;
+            indexes.addTokens(parameterId.substring(juce::String(CHORDBUILDS_ID).length()), "_", "");
+            if(! hasChordBuilds && indexes.size() == 3)
+            {
+                const auto prog = indexes[0].getIntValue();
+                const auto zone = indexes[1].getIntValue();
+                const auto note = indexes[2].getIntValue();
+                if(prog >= 0 && prog < MAX_PROGRESSIONS && zone >= 0 && zone < MAX_ZONES && note >= 0 && note < MAX_NOTES)
+                {
+                    chordBuilds.Set(prog, zone, note, (int) state.getChild(i).getProperty("value"));
+                }
+            }
+            state.removeChild(i, nullptr);
+        }
+        else if(parameterId.startsWith(NOTESTOPLAY_ID))
+        {
+            state.removeChild(i, nullptr);
+        }
+    }
+    if(! hasChordBuilds)
+    {
+        state.setProperty(CHORDBUILDS_ID, juce::String(chordBuilds.ToState()), nullptr);
+    }
+}
 //If the valueTree is replaced, the currentPreset must refer to the new valueTree.
 void PresetManager::valueTreeRedirected(juce::ValueTree& treeWhichHasChanged)
 {
@@ -11,6 +11,10 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <map>
+#include <unordered_map>
+#include "PresetDirectory.h"
+#include "../Engine/PresetBankFile.h"
 
 namespace Service
 {
@@ -18,27 +22,120 @@ using namespace juce;
 
 typedef enum {notLoading, startLoading, isLoading, finishLoading} ePresetLoading;
 
-class PresetManager : ValueTree::Listener
+class PresetManager : ValueTree::Listener, private AsyncUpdater, private PresetDirectory::Listener
 {
 public:
     static const File defaultDirectory;
     static const String extension;
+    static const String bankExtension;
     static const String presetNameProperty;
     static inline ePresetLoading PresetLoading = ePresetLoading::notLoading;
 
     PresetManager(AudioProcessorValueTreeState&);
+    ~PresetManager() override;
     
     void savePreset(const String& presetName);
     void deletePreset(const String& presetName);
+    // the preset is read on a background thread and applied on the message thread when it is ready.
+    // A preset that is still loading is dropped when the next one is requested.
     void loadPreset(const String& presetName);
     int loadNextPreset();
     int loadPreviousPreset();
+    // the names of the presets, in alphabetical order. From the index, so without disk access.
     StringArray getAllPresets() const;
+    // the presets whose name starts with the text
+    StringArray findPresets(const String& text) const;
+    // changes when presets are added, removed or changed, also by other programs
+    int getPresetListVersion() const { return presetDirectory->getVersion(); }
     String getCurrentPreset() const;
 
+    // reads the first maxPresets presets on the background thread, for the preset bank
+    void loadBank(int maxPresets);
+    // applies a state of the bank on the message thread, like a loaded preset
+    void applyBankPreset(const ValueTree& state, const String& presetName);
+
+    // writes all preset files into one bank file (see Engine/PresetBankFile.h). Bank files in the preset
+    // directory are listed with the preset files. Returns the number of presets, -1 when it could not be written.
+    int exportBank(const File& bankFile);
+    // writes the presets of a bank file as preset files. Returns the number of presets, -1 when it is not a bank.
+    int importBank(const File& bankFile);
+
+    // converts a state or preset of an older version, before it is loaded
+    static void migrateState(ValueTree& state);
+
+    // called on the loading thread with the (migrated) state of the preset, e.g. to compile what the
+    // audio thread needs from it. Presets of a bank file are read on the message thread, so it is called
+    // there for them. A preset that is dropped can still be parsed after the next one, so the request
+    // identifies the preset.
+    std::function<void(const ValueTree& state, int request)> onPresetParsed;
+    // called on the message thread right before the state of the preset replaces the current state,
+    // with the request that was parsed (0 for a state that was not parsed, applyBankPreset)
+    std::function<void(int request)> onPresetApplying;
+    // called on the message thread with the parameters of the preset whose value changed, after the properties
+    // of the state are set. Sets them together, e.g. in one transaction. Without it they are set one by one.
+    struct ParameterValue
+    {
+        RangedAudioParameter* parameter;
+        float value; // normalised
+    };
+    std::function<void(const std::vector<ParameterValue>& changes)> onApplyParameters;
+    // called on the message thread after a preset has been loaded
+    std::function<void()> onPresetLoaded;
+    // called on the loading thread with the (migrated) states of the bank, and on the message thread when it has been loaded
+    std::function<void(const Array<ValueTree>& states)> onBankParsed;
+    std::function<void(const StringArray& presetNames, const Array<ValueTree>& states)> onBankLoaded;
+    // called on the message thread when the list of presets changed (see getPresetListVersion)
+    std::function<void()> onPresetListChanged;
+
 private:
     void valueTreeRedirected(juce::ValueTree& treeWhichHasChanged) override;
+    void handleAsyncUpdate() override;
+    void applyPreset(const ValueTree& valueTreeToLoad, const String& presetName, int request);
+    void presetIndexChanged() override;
+
+    //==============================================================================
+    // preset files and bank files
+    //==============================================================================
+    struct MappedBank
+    {
+        std::unique_ptr<MemoryMappedFile> mappedFile;
+        PresetBankFile bank;
+        bool isOpen = false;
+    };
+    using MappedBanks = std::map<String, MappedBank>;
+    static ValueTree readPresetFile(const File& presetFile);
+    // reads a record of a bank in place. The bank is mapped and opened once for the banks it is given.
+    ValueTree readBankPreset(MappedBanks& banks, const File& bankFile, int record) const;
+    static BinaryState toBinaryState(const ValueTree& state);
+    ValueTree fromBinaryState(const BinaryState& state) const;
+    MappedBanks mappedBanks; // message thread, cleared when the index changes
+    Identifier stateType;
+    std::unordered_map<std::uint32_t, String> parameterIDs; // the parameter id for BinaryState::HashID
+    std::vector<std::atomic<float>*> rawValues; // the raw value of the value tree state, by parameter index
     AudioProcessorValueTreeState& valueTreeState;
     Value currentPreset; //Value object of juce
+
+    //==============================================================================
+    // background loading
+    //==============================================================================
+    ThreadPool loadingThread {1};
+    std::atomic<int> latestRequest {0};
+    String requestedPreset; // message thread, the preset that is loading
+    CriticalSection loadedLock;
+    ValueTree loadedState;
+    String loadedPresetName;
+    int loadedRequest = 0;
+
+    std::atomic<int> latestBankRequest {0};
+    bool bankIsLoaded = false;
+    StringArray loadedBankNames;
+    Array<ValueTree> loadedBankStates;
+    int loadedBankRequest = 0;
+
+    //==============================================================================
+    // preset index, shared by the instances (see PresetDirectory.h)
+    //==============================================================================
+    SharedResourcePointer<PresetDirectory> presetDirectory;
+    const PresetIndex& presetIndex() const { return presetDirectory->getIndex(); }
 };
 }
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    BinaryStateTests.cpp
+    Created: 18 Oct 2026 3:31:12pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "BinaryState.h"
+#include "ChordBuilds.h"
+#include "Tests.h"
+
+namespace
+{
+BinaryState CreateState()
+{
+    auto builds = ChordBuilds::CreateDefault();
+    builds.Set(0, 0, 1, 4);
+    builds.Set(0, 0, 2, 7);
+    builds.Set(1, 3, 1, -5);
+
+    BinaryState state;
+    state.parameters = {{BinaryState::HashID("midicc"), 74.0f}, {BinaryState::HashID("transpose"), -3.0f},
+                        {BinaryState::HashID("velocity"), 0.75f}};
+    state.chordBuilds = builds.ToBytes();
+    state.deliveryPolicy = {DeliveryMode::spreadOverSamples, 3, 128, 256};
+    state.presetName = "Warm pad";
+    state.pluginVersion = "1.0.1";
+    state.presetBank.enabled = true;
+    state.presetBank.next = {1, 2, 64, 64, 128};
+    state.presetBank.previous = {2, 1, 60, 1, 128};
+    return state;
+}
+
+bool IsEqual(const LearnedControl& first, const LearnedControl& second)
+{
+    return first.messageType == second.messageType && first.channel == second.channel && first.number == second.number
+        && first.minValue == second.minValue && first.maxValue == second.maxValue;
+}
+
+bool IsEqual(const BinaryState& first, const BinaryState& second)
+{
+    if(first.parameters.size() != second.parameters.size()) return false;
+    for(std::size_t i=0;i<first.parameters.size();i++)
+    {
+        if(first.parameters[i].idHash != second.parameters[i].idHash || first.parameters[i].value != second.parameters[i].value) return false;
+    }
+    return first.chordBuilds == second.chordBuilds
+        && first.deliveryPolicy.mode == second.deliveryPolicy.mode
+        && first.deliveryPolicy.eventsPerBlock == second.deliveryPolicy.eventsPerBlock
+        && first.deliveryPolicy.spreadSamples == second.deliveryPolicy.spreadSamples
+        && first.deliveryPolicy.maxBlockSize == second.deliveryPolicy.maxBlockSize
+        && first.presetName == second.presetName && first.pluginVersion == second.pluginVersion
+        && first.presetBank.enabled == second.presetBank.enabled
+        && IsEqual(first.presetBank.next, second.presetBank.next) && IsEqual(first.presetBank.previous, second.presetBank.previous);
+}
+
+std::vector<std::uint8_t> ToBytes(const BinaryState& state)
+{
+    std::vector<std::uint8_t> bytes(state.GetSize());
+    state.Write(bytes.data());
+    return bytes;
+}
+}
+
+TEST(BinaryState, RoundTrip)
+{
+    const auto state = CreateState();
+    const auto bytes = ToBytes(state);
+    CHECK(BinaryState::IsBinaryState(bytes.data(), bytes.size()));
+    BinaryState read;
+    CHECK(read.Read(bytes.data(), bytes.size()));
+    CHECK(IsEqual(read, state));
+}
+
+TEST(BinaryState, EmptyState)
+{
+    const BinaryState state;
+    const auto bytes = ToBytes(state);
+    auto read = CreateState();
+    CHECK(read.Read(bytes.data(), bytes.size()));
+    CHECK(IsEqual(read, state));
+}
+
+// a state that is cut off is not read, and the state that reads it is not changed
+TEST(BinaryState, Truncated)
+{
+    const auto bytes = ToBytes(CreateState());
+    for(std::size_t size=0;size<bytes.size();size++)
+    {
+        BinaryState read;
+        CHECK(! read.Read(bytes.data(), size));
+        CHECK(IsEqual(read, BinaryState()));
+    }
+}
+
+// damaged bytes are either read or not, but never read outside of the data
+TEST(BinaryState, Corrupted)
+{
+    const auto state = CreateState();
+    const auto bytes = ToBytes(state);
+    for(std::size_t bit=0;bit<bytes.size()*8;bit++)
+    {
+        const auto damaged = Tests::FlipBit(bytes, bit);
+        auto read = state;
+        if(! read.Read(damaged.data(), damaged.size()))
+        {
+            CHECK(IsEqual(read, state));
+        }
+    }
+}
+
+TEST(BinaryState, OlderFormats)
+{
+    auto state = CreateState();
+    const auto bytes = ToBytes(state);
+
+    // format 2 has no max block size
+    auto format2 = std::vector<std::uint8_t>(bytes.begin(), bytes.end() - 4);
+    format2[4] = 2;
+    BinaryState read;
+    CHECK(read.Read(format2.data(), format2.size()));
+    state.deliveryPolicy.maxBlockSize = 0;
+    CHECK(IsEqual(read, state));
+
+    // format 1 has no preset bank settings either
+    auto format1 = std::vector<std::uint8_t>(format2.begin(), format2.end() - 11);
+    format1[4] = 1;
+    read = BinaryState();
+    CHECK(read.Read(format1.data(), format1.size()));
+    state.presetBank = PresetBankSettings();
+    CHECK(IsEqual(read, state));
+}
+
+TEST(BinaryState, UnknownData)
+{
+    auto bytes = ToBytes(CreateState());
+    bytes[4] = (std::uint8_t) (BinaryState::FormatVersion + 1);
+    BinaryState read;
+    CHECK(! read.Read(bytes.data(), bytes.size()));
+    bytes[4] = 0;
+    CHECK(! read.Read(bytes.data(), bytes.size()));
+
+    // the xml state of older versions
+    const char xml[] = "VC2!\x12\x01\0\0<?xml version=\"1.0\"?>";
+    CHECK(! BinaryState::IsBinaryState(xml, sizeof(xml)));
+    CHECK(! read.Read(xml, sizeof(xml)));
+    CHECK(! read.Read(nullptr, 0));
+}
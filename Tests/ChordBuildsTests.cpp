@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    ChordBuildsTests.cpp
+    Created: 18 Oct 2026 3:44:05pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include <cstring>
+#include <string>
+#include "ChordBuilds.h"
+#include "Tests.h"
+
+namespace
+{
+ChordBuilds CreateBuilds()
+{
+    auto builds = ChordBuilds::CreateDefault();
+    for(int prog=0;prog<MAX_PROGRESSIONS;prog++)
+    {
+        for(int zone=0;zone<MAX_ZONES;zone++)
+        {
+            builds.Set(prog, zone, 1, (prog * 7 + zone * 3) % 24 - 12);
+        }
+    }
+    builds.Set(0, 0, 2, ChordBuilds::MinInterval);
+    builds.Set(0, 0, 3, ChordBuilds::MaxInterval);
+    builds.Set(1, 1, 1, NONOTE);
+    return builds;
+}
+
+bool IsEqual(const ChordBuilds& first, const ChordBuilds& second)
+{
+    return std::memcmp(first.intervals, second.intervals, sizeof(first.intervals)) == 0;
+}
+}
+
+TEST(ChordBuilds, RoundTripState)
+{
+    const auto builds = CreateBuilds();
+    auto read = ChordBuilds::CreateDefault();
+    CHECK(read.FromState(builds.ToState()));
+    CHECK(IsEqual(read, builds));
+}
+
+TEST(ChordBuilds, RoundTripBytes)
+{
+    const auto builds = CreateBuilds();
+    const auto bytes = builds.ToBytes();
+    auto read = ChordBuilds::CreateDefault();
+    CHECK(read.FromBytes(bytes.data(), bytes.size()));
+    CHECK(IsEqual(read, builds));
+}
+
+TEST(ChordBuilds, SetClamps)
+{
+    auto builds = ChordBuilds::CreateDefault();
+    builds.Set(0, 0, 1, 1000);
+    builds.Set(0, 0, 2, -1000);
+    builds.Set(0, 0, 3, NONOTE);
+    CHECK(builds.Get(0, 0, 1) == ChordBuilds::MaxInterval);
+    CHECK(builds.Get(0, 0, 2) == ChordBuilds::MinInterval);
+    CHECK(builds.Get(0, 0, 3) == NONOTE);
+}
+
+// a state that is cut off is either not read (nothing changes) or, when only the padding is
+// missing, read completely
+TEST(ChordBuilds, TruncatedState)
+{
+    const auto builds = CreateBuilds();
+    const auto state = builds.ToState();
+    for(std::size_t size=0;size<state.size();size++)
+    {
+        auto read = ChordBuilds::CreateDefault();
+        if(read.FromState(state.substr(0, size)))
+        {
+            CHECK(IsEqual(read, builds));
+        }
+        else
+        {
+            CHECK(IsEqual(read, ChordBuilds::CreateDefault()));
+        }
+    }
+}
+
+TEST(ChordBuilds, TruncatedBytes)
+{
+    const auto bytes = CreateBuilds().ToBytes();
+    for(std::size_t size=0;size<bytes.size();size++)
+    {
+        auto read = ChordBuilds::CreateDefault();
+        CHECK(! read.FromBytes(bytes.data(), size));
+        CHECK(IsEqual(read, ChordBuilds::CreateDefault()));
+    }
+}
+
+TEST(ChordBuilds, CorruptedState)
+{
+    const auto state = CreateBuilds().ToState();
+    auto read = ChordBuilds::CreateDefault();
+    CHECK(! read.FromState(state.substr(0, 8) + "*" + state.substr(9)));
+    CHECK(! read.FromState("not a chord build state"));
+    CHECK(IsEqual(read, ChordBuilds::CreateDefault()));
+
+    // every damaged byte: read or not, never outside of the data
+    const auto bytes = CreateBuilds().ToBytes();
+    for(std::size_t bit=0;bit<bytes.size()*8;bit++)
+    {
+        const auto damaged = Tests::FlipBit(bytes, bit);
+        auto builds = ChordBuilds::CreateDefault();
+        if(! builds.FromBytes(damaged.data(), damaged.size()))
+        {
+            CHECK(IsEqual(builds, ChordBuilds::CreateDefault()));
+        }
+    }
+}
+
+TEST(ChordBuilds, UnknownVersion)
+{
+    auto bytes = CreateBuilds().ToBytes();
+    bytes[0] = (std::uint8_t) (ChordBuilds::StateVersion + 1);
+    auto read = ChordBuilds::CreateDefault();
+    CHECK(! read.FromBytes(bytes.data(), bytes.size()));
+    CHECK(IsEqual(read, ChordBuilds::CreateDefault()));
+}
+
+// a state with other dimensions is copied as far as they overlap
+TEST(ChordBuilds, OtherDimensions)
+{
+    const std::uint8_t bytes[] = {(std::uint8_t) ChordBuilds::StateVersion, 1, 2, 3, 0, 4, 7, 0, 3, (std::uint8_t) NONOTE};
+    auto read = CreateBuilds();
+    CHECK(read.FromBytes(bytes, sizeof(bytes)));
+    CHECK(read.Get(0, 0, 1) == 4);
+    CHECK(read.Get(0, 0, 2) == 7);
+    CHECK(read.Get(0, 1, 1) == 3);
+    CHECK(read.Get(0, 1, 2) == NONOTE);
+    CHECK(read.Get(0, 0, 3) == NONOTE);
+    CHECK(read.Get(1, 0, 1) == NONOTE);
+}
@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    DeliverySchedulerTests.cpp
+    Created: 18 Oct 2026 7:31:36pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include <vector>
+#include "DeliveryScheduler.h"
+#include "Tests.h"
+
+namespace
+{
+const int BlockSize = 64;
+
+// a chord change of numEvents events at the sample
+void QueueChange(MidiEventQueue& queue, int numEvents, int samplePosition)
+{
+    queue.prepare(MAX_EVENTS_PER_CHANGE);
+    for(int i=0;i<numEvents;i++)
+    {
+        queue.push(MidiEvent::noteOn(1, 60 + i, 100, samplePosition));
+    }
+}
+
+// the sample positions of the events of each block, until the queue is empty
+std::vector<std::vector<int>> Deliver(DeliveryScheduler& scheduler, MidiEventQueue& queue, int numSamples, int& maxDelay)
+{
+    std::vector<std::vector<int>> blocks;
+    maxDelay = 0;
+    while(! queue.isEmpty() && blocks.size() < 100)
+    {
+        blocks.emplace_back();
+        auto delay = scheduler.deliver(queue, numSamples, [&](const MidiEvent&, int position) { blocks.back().push_back(position); });
+        maxDelay = delay > maxDelay ? delay : maxDelay;
+    }
+    return blocks;
+}
+}
+
+TEST(DeliveryScheduler, AllAtOnce)
+{
+    DeliveryScheduler scheduler;
+    MidiEventQueue queue;
+    QueueChange(queue, 3, 10);
+    int maxDelay;
+    const auto blocks = Deliver(scheduler, queue, BlockSize, maxDelay);
+    CHECK((blocks == std::vector<std::vector<int>>{{10, 10, 10}}));
+    CHECK(maxDelay == 0);
+    CHECK(DeliveryScheduler::getLatencySamples(scheduler.getPolicy(), BlockSize) == 0);
+}
+
+// events that have to wait stay queued with a negative position, which is how late they are
+TEST(DeliveryScheduler, EventsPerBlock)
+{
+    DeliveryScheduler scheduler;
+    scheduler.setPolicy({DeliveryMode::eventsPerBlock, 2, 64, 0});
+    CHECK(scheduler.holdsBackEvents(BlockSize));
+    MidiEventQueue queue;
+    QueueChange(queue, 5, 10);
+    scheduler.deliver(queue, BlockSize, [](const MidiEvent&, int) {});
+    CHECK(queue.size() == 3);
+    CHECK(queue.front().samplePosition == 10 - BlockSize);
+
+    int maxDelay;
+    const auto blocks = Deliver(scheduler, queue, BlockSize, maxDelay);
+    CHECK((blocks == std::vector<std::vector<int>>{{0, 0}, {0}}));
+    CHECK(maxDelay == 2 * BlockSize - 10);
+    CHECK(maxDelay <= DeliveryScheduler::getLatencySamples(scheduler.getPolicy(), BlockSize));
+}
+
+// blocks larger than maxBlockSize are not limited
+TEST(DeliveryScheduler, MaxBlockSize)
+{
+    DeliveryScheduler scheduler;
+    scheduler.setPolicy({DeliveryMode::eventsPerBlock, 1, 64, 256});
+    CHECK(scheduler.holdsBackEvents(256));
+    CHECK(! scheduler.holdsBackEvents(512));
+    CHECK(DeliveryScheduler::getLatencySamples(scheduler.getPolicy(), 512) == 0);
+    CHECK(DeliveryScheduler::getLatencySamples(scheduler.getPolicy(), 256) == (MAX_EVENTS_PER_CHANGE - 1) * 256);
+
+    MidiEventQueue queue;
+    QueueChange(queue, 3, 10);
+    int maxDelay;
+    CHECK(Deliver(scheduler, queue, 512, maxDelay).size() == 1);
+    QueueChange(queue, 3, 10);
+    CHECK(Deliver(scheduler, queue, 256, maxDelay).size() == 3);
+}
+
+// the last event of the largest change is played at most spreadSamples after the first, also across blocks
+TEST(DeliveryScheduler, SpreadOverSamples)
+{
+    DeliveryScheduler scheduler;
+    scheduler.setPolicy({DeliveryMode::spreadOverSamples, 1, 70, 0});
+    MidiEventQueue queue;
+    QueueChange(queue, MAX_EVENTS_PER_CHANGE, 40);
+    int maxDelay;
+    const auto blocks = Deliver(scheduler, queue, BlockSize, maxDelay);
+    CHECK(blocks.size() == 2);
+    std::vector<int> positions;
+    for(std::size_t block=0;block<blocks.size();block++)
+        for(auto position : blocks[block])
+            positions.push_back(position + (int) block * BlockSize);
+    CHECK((int) positions.size() == MAX_EVENTS_PER_CHANGE);
+    for(std::size_t i=1;i<positions.size();i++)
+    {
+        CHECK(positions[i] - positions[i - 1] == 2);
+    }
+    CHECK(positions.back() - positions.front() <= 70);
+    CHECK(maxDelay == positions.back() - 40);
+    CHECK(maxDelay == DeliveryScheduler::getLatencySamples(scheduler.getPolicy(), BlockSize));
+}
+
+// a reset forgets the spacing that is carried over to the next block
+TEST(DeliveryScheduler, Reset)
+{
+    DeliveryScheduler scheduler;
+    scheduler.setPolicy({DeliveryMode::spreadOverSamples, 1, 350, 0});
+    MidiEventQueue queue;
+    QueueChange(queue, 1, 60);
+    scheduler.deliver(queue, BlockSize, [](const MidiEvent&, int) {});
+    scheduler.reset();
+    QueueChange(queue, 1, 0);
+    int maxDelay;
+    const auto blocks = Deliver(scheduler, queue, BlockSize, maxDelay);
+    CHECK((blocks == std::vector<std::vector<int>>{{0}}));
+}
+
+// invalid settings are corrected
+TEST(DeliveryScheduler, SetPolicy)
+{
+    DeliveryScheduler scheduler;
+    scheduler.setPolicy({DeliveryMode::eventsPerBlock, 0, -5, 0});
+    CHECK(scheduler.getPolicy().eventsPerBlock == 1);
+    CHECK(scheduler.getPolicy().spreadSamples == 0);
+}
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    MidiEventQueueTests.cpp
+    Created: 18 Oct 2026 7:12:48pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "MidiEventQueue.h"
+#include "Tests.h"
+
+namespace
+{
+// a queue of the given capacity with notes 60, 61, ... at sample 0, 1, ...
+void FillQueue(MidiEventQueue& queue, int capacity, int numEvents)
+{
+    queue.prepare(capacity);
+    for(int i=0;i<numEvents;i++)
+    {
+        queue.push(MidiEvent::noteOn(1, 60 + i, 100, i));
+    }
+}
+
+int PopNote(MidiEventQueue& queue)
+{
+    MidiEvent event;
+    return queue.pop(event) ? event.data[1] : -1;
+}
+}
+
+TEST(MidiEventQueue, FirstInFirstOut)
+{
+    MidiEventQueue queue;
+    FillQueue(queue, 4, 3);
+    CHECK(queue.size() == 3);
+    CHECK(queue.front().data[1] == 60);
+    CHECK(PopNote(queue) == 60);
+    // wraps around the end of the storage
+    queue.push(MidiEvent::noteOn(1, 70, 100, 0));
+    queue.push(MidiEvent::noteOn(1, 71, 100, 0));
+    CHECK(queue.size() == 4);
+    CHECK(PopNote(queue) == 61);
+    CHECK(PopNote(queue) == 62);
+    CHECK(PopNote(queue) == 70);
+    CHECK(PopNote(queue) == 71);
+    CHECK(PopNote(queue) == -1);
+    CHECK(queue.isEmpty());
+    CHECK(queue.getOverflowCount() == 0);
+}
+
+// a full queue keeps its events and counts the ones it rejects
+TEST(MidiEventQueue, DropNewest)
+{
+    MidiEventQueue queue;
+    FillQueue(queue, 4, 4);
+    CHECK(! queue.push(MidiEvent::noteOn(1, 70, 100, 0)));
+    CHECK(! queue.push(MidiEvent::noteOn(1, 71, 100, 0)));
+    CHECK(queue.getOverflowCount() == 2);
+    CHECK(queue.size() == 4);
+    CHECK(PopNote(queue) == 60);
+    queue.resetOverflowCount();
+    CHECK(queue.getOverflowCount() == 0);
+}
+
+TEST(MidiEventQueue, DropOldest)
+{
+    MidiEventQueue queue;
+    FillQueue(queue, 4, 4);
+    queue.setOverflowPolicy(QueueOverflowPolicy::dropOldest);
+    CHECK(queue.push(MidiEvent::noteOn(1, 70, 100, 0)));
+    CHECK(queue.getOverflowCount() == 1);
+    CHECK(queue.size() == 4);
+    CHECK(PopNote(queue) == 61);
+    CHECK(PopNote(queue) == 62);
+    CHECK(PopNote(queue) == 63);
+    CHECK(PopNote(queue) == 70);
+}
+
+// prepare empties the queue, and nothing is queued before it
+TEST(MidiEventQueue, Prepare)
+{
+    MidiEventQueue queue;
+    CHECK(! queue.push(MidiEvent::noteOn(1, 60, 100, 0)));
+    CHECK(queue.getOverflowCount() == 1);
+
+    FillQueue(queue, 4, 2);
+    queue.prepare(4);
+    CHECK(queue.isEmpty());
+    CHECK(queue.capacity() == 4);
+    queue.prepare(0);
+    CHECK(queue.capacity() == 1);
+}
+
+TEST(MidiEventQueue, ShiftSamplePositions)
+{
+    MidiEventQueue queue;
+    FillQueue(queue, 4, 3);
+    queue.shiftSamplePositions(-2);
+    MidiEvent event;
+    queue.pop(event);
+    CHECK(event.samplePosition == -2);
+    queue.pop(event);
+    CHECK(event.samplePosition == -1);
+    queue.pop(event);
+    CHECK(event.samplePosition == 0);
+}
+
+// the last note on of the note is removed and the queue closes the gap, also across the end of the storage
+TEST(MidiEventQueue, RemoveNoteOn)
+{
+    MidiEventQueue queue;
+    FillQueue(queue, 4, 3);
+    PopNote(queue);
+    PopNote(queue);
+    queue.push(MidiEvent::noteOn(1, 61, 100, 3));
+    queue.push(MidiEvent::noteOn(1, 64, 100, 4));
+    CHECK(queue.removeNoteOn(1, 61, false));
+    CHECK(queue.size() == 2);
+    CHECK(PopNote(queue) == 62);
+    CHECK(PopNote(queue) == 64);
+
+    // other channels and other notes are not removed
+    FillQueue(queue, 4, 2);
+    CHECK(! queue.removeNoteOn(2, 60, false));
+    CHECK(! queue.removeNoteOn(1, 70, false));
+    CHECK(queue.size() == 2);
+}
+
+// a note on that is followed by a note off of the note, or that is not late, stays queued
+TEST(MidiEventQueue, RemoveNoteOnKeepsPlayedNotes)
+{
+    MidiEventQueue queue;
+    FillQueue(queue, 8, 1);
+    queue.push(MidiEvent::noteOff(1, 60, 1));
+    CHECK(! queue.removeNoteOn(1, 60, false));
+    queue.push(MidiEvent::noteOn(1, 60, 0, 2));
+    CHECK(! queue.removeNoteOn(1, 60, false));
+    CHECK(queue.size() == 3);
+
+    FillQueue(queue, 8, 2);
+    CHECK(! queue.removeNoteOn(1, 61, true));
+    queue.shiftSamplePositions(-2);
+    CHECK(queue.removeNoteOn(1, 61, true));
+    CHECK(queue.size() == 1);
+}
@@ -0,0 +1,170 @@
+/*
+  ==============================================================================
+
+    MidiFileTests.cpp
+    Created: 18 Oct 2026 4:12:30pm
+    Author:  PJP
+
+    The files are written to the working directory of the test.
+
+  ==============================================================================
+*/
+
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include "MidiFile.h"
+#include "Tests.h"
+
+namespace
+{
+const char* const TestFile = "RibbonTests.mid";
+
+std::vector<MidiFileEvent> CreateEvents()
+{
+    return {
+        {0, {0xff, 0x51, 0x07, 0xa1, 0x20}},            // 120 bpm
+        {0, {0xc0, 0x05}},                              // program change, one data byte
+        {0, {0x90, 60, 100}},
+        {240, {0xb0, 1, 64}},
+        {480, {0x80, 60, 0}},
+        {480, {0xff, 0x51, 0x0f, 0x42, 0x40}},          // 60 bpm
+        {960, {0xf0, 0x7e, 0x7f, 0x09, 0x01, 0xf7}},    // sysex
+        {1440, {0x90, 64, 90}},
+        {1920, {0x90, 64, 0}},
+    };
+}
+
+bool IsEqual(const MidiFileEvent& first, const MidiFileEvent& second)
+{
+    return first.tick == second.tick && first.data == second.data;
+}
+
+std::vector<std::uint8_t> ReadBytes(const char* path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    return std::vector<std::uint8_t>((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+}
+
+bool WriteBytes(const char* path, const std::vector<std::uint8_t>& bytes, std::size_t size)
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    return (bool) stream.write((const char*) bytes.data(), (std::streamsize) size);
+}
+
+std::vector<std::uint8_t> CreateFileBytes()
+{
+    MidiFile file;
+    file.SetEvents(CreateEvents());
+    std::string error;
+    if(! file.Write(TestFile, error)) return {};
+    return ReadBytes(TestFile);
+}
+}
+
+TEST(MidiFile, RoundTrip)
+{
+    MidiFile file;
+    file.SetEvents(CreateEvents());
+    std::string error;
+    CHECK(file.Write(TestFile, error));
+
+    MidiFile read;
+    CHECK(read.Read(TestFile, error));
+    CHECK(read.GetTicksPerQuarterNote() == 480);
+    const auto events = CreateEvents();
+    CHECK(read.GetEvents().size() == events.size());
+    for(std::size_t i=0;i<events.size() && i<read.GetEvents().size();i++)
+    {
+        CHECK(IsEqual(read.GetEvents()[i], events[i]));
+    }
+}
+
+TEST(MidiFile, TempoMap)
+{
+    MidiFile file;
+    file.SetEvents(CreateEvents());
+    std::string error;
+    CHECK(file.Write(TestFile, error));
+    MidiFile read;
+    CHECK(read.Read(TestFile, error));
+    // 120 bpm up to tick 480, 60 bpm from there on
+    CHECK(std::abs(read.TickToSeconds(480) - 0.5) < 1.0e-9);
+    CHECK(std::abs(read.TickToSeconds(960) - 1.5) < 1.0e-9);
+    CHECK(read.SecondsToTick(1.5) == 960);
+}
+
+// format 1 with running status: the tracks are merged by tick, in the order of the tracks at the same tick
+TEST(MidiFile, Format1)
+{
+    const std::vector<std::uint8_t> bytes {
+        'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0x01, 0xe0,
+        'M', 'T', 'r', 'k', 0, 0, 0, 12, 0x00, 0x90, 60, 100, 0x60, 62, 100, 0x00, 0xff, 0x2f, 0x00, 0x00,
+        'M', 'T', 'r', 'k', 0, 0, 0, 8, 0x00, 0xb0, 7, 90, 0x60, 0x90, 64, 100,
+    };
+    CHECK(WriteBytes(TestFile, bytes, bytes.size()));
+    MidiFile read;
+    std::string error;
+    CHECK(read.Read(TestFile, error));
+    const std::vector<MidiFileEvent> expected {
+        {0, {0x90, 60, 100}}, {0, {0xb0, 7, 90}}, {96, {0x90, 62, 100}}, {96, {0x90, 64, 100}},
+    };
+    CHECK(read.GetEvents().size() == expected.size());
+    for(std::size_t i=0;i<expected.size() && i<read.GetEvents().size();i++)
+    {
+        CHECK(IsEqual(read.GetEvents()[i], expected[i]));
+    }
+}
+
+// a file that is cut off is either not read, or read up to an event
+TEST(MidiFile, Truncated)
+{
+    const auto bytes = CreateFileBytes();
+    CHECK(! bytes.empty());
+    const auto events = CreateEvents();
+    for(std::size_t size=0;size<bytes.size();size++)
+    {
+        CHECK(WriteBytes(TestFile, bytes, size));
+        MidiFile read;
+        std::string error;
+        if(read.Read(TestFile, error))
+        {
+            CHECK(read.GetEvents().size() <= events.size());
+            for(std::size_t i=0;i<read.GetEvents().size() && i<events.size();i++)
+            {
+                CHECK(IsEqual(read.GetEvents()[i], events[i]));
+            }
+        }
+        else
+        {
+            CHECK(! error.empty());
+        }
+    }
+}
+
+// a damaged file is either read or not, but never read outside of its data
+TEST(MidiFile, Corrupted)
+{
+    const auto bytes = CreateFileBytes();
+    for(std::size_t bit=0;bit<bytes.size()*8;bit++)
+    {
+        const auto damaged = Tests::FlipBit(bytes, bit);
+        CHECK(WriteBytes(TestFile, damaged, damaged.size()));
+        MidiFile read;
+        std::string error;
+        if(read.Read(TestFile, error))
+        {
+            read.TickToSeconds(1000);
+        }
+    }
+}
+
+TEST(MidiFile, NotAMidiFile)
+{
+    const std::vector<std::uint8_t> bytes {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E', 0, 0, 0, 0};
+    CHECK(WriteBytes(TestFile, bytes, bytes.size()));
+    MidiFile read;
+    std::string error;
+    CHECK(! read.Read(TestFile, error));
+    CHECK(! read.Read("RibbonTests does not exist.mid", error));
+}
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    NoteTrackerTests.cpp
+    Created: 18 Oct 2026 7:20:05pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include <utility>
+#include <vector>
+#include "NoteTracker.h"
+#include "Tests.h"
+
+TEST(NoteTracker, NoteOnAndOff)
+{
+    NoteTracker tracker;
+    CHECK(! tracker.IsAnySounding());
+    tracker.NoteOn(1, 0);
+    tracker.NoteOn(1, 127);
+    tracker.NoteOn(16, 64);
+    CHECK(tracker.IsSounding(1, 0) && tracker.IsSounding(1, 127) && tracker.IsSounding(16, 64));
+    CHECK(! tracker.IsSounding(2, 0));
+    CHECK(! tracker.IsSounding(16, 63));
+    CHECK(tracker.IsChannelSounding(16));
+
+    tracker.NoteOff(16, 64);
+    CHECK(! tracker.IsChannelSounding(16));
+    CHECK(tracker.IsAnySounding());
+    tracker.NoteOff(1, 0);
+    CHECK(tracker.IsChannelSounding(1));
+    tracker.NoteOff(1, 127);
+    CHECK(! tracker.IsAnySounding());
+
+    tracker.NoteOn(3, 60);
+    tracker.Clear();
+    CHECK(! tracker.IsAnySounding());
+    CHECK(! tracker.IsSounding(3, 60));
+}
+
+// in order of channel and note, and the function may stop the notes it gets
+TEST(NoteTracker, ForEachSounding)
+{
+    NoteTracker tracker;
+    tracker.NoteOn(2, 70);
+    tracker.NoteOn(1, 100);
+    tracker.NoteOn(1, 5);
+    std::vector<std::pair<int, int>> notes;
+    tracker.ForEachSounding([&](int channel, int note)
+    {
+        notes.push_back({channel, note});
+        tracker.NoteOff(channel, note);
+    });
+    CHECK((notes == std::vector<std::pair<int, int>>{{1, 5}, {1, 100}, {2, 70}}));
+    CHECK(! tracker.IsAnySounding());
+}
@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    PresetBankFileTests.cpp
+    Created: 18 Oct 2026 3:58:47pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "ChordBuilds.h"
+#include "PresetBankFile.h"
+#include "Tests.h"
+
+namespace
+{
+std::vector<PresetBankFile::Preset> CreatePresets()
+{
+    std::vector<PresetBankFile::Preset> presets(3);
+    for(std::size_t i=0;i<presets.size();i++)
+    {
+        auto builds = ChordBuilds::CreateDefault();
+        builds.Set((int) i, 0, 1, 3 + (int) i);
+        presets[i].name = "Preset " + std::to_string(i + 1);
+        presets[i].state.parameters = {{BinaryState::HashID("midicc"), 10.0f + (float) i}, {BinaryState::HashID("legato"), 1.0f}};
+        presets[i].state.chordBuilds = builds.ToBytes();
+        presets[i].state.presetName = presets[i].name;
+        presets[i].state.pluginVersion = "1.0.1";
+    }
+    presets[2].name.clear(); // a record without a name can still be read
+    return presets;
+}
+
+bool IsEqual(const BinaryState& first, const BinaryState& second)
+{
+    if(first.parameters.size() != second.parameters.size()) return false;
+    for(std::size_t i=0;i<first.parameters.size();i++)
+    {
+        if(first.parameters[i].idHash != second.parameters[i].idHash || first.parameters[i].value != second.parameters[i].value) return false;
+    }
+    return first.chordBuilds == second.chordBuilds && first.presetName == second.presetName && first.pluginVersion == second.pluginVersion;
+}
+
+// every record of an open bank, the reads must stay inside the data
+void ReadAll(const PresetBankFile& bank)
+{
+    for(int i=0;i<bank.GetNumPresets();i++)
+    {
+        BinaryState state;
+        bank.GetName(i);
+        bank.ReadPreset(i, state);
+    }
+}
+}
+
+TEST(PresetBankFile, RoundTrip)
+{
+    const auto presets = CreatePresets();
+    const auto bytes = PresetBankFile::Write(presets);
+    CHECK(PresetBankFile::IsPresetBank(bytes.data(), bytes.size()));
+    PresetBankFile bank;
+    CHECK(bank.Open(bytes.data(), bytes.size()));
+    CHECK(bank.GetNumPresets() == (int) presets.size());
+    for(int i=0;i<bank.GetNumPresets();i++)
+    {
+        BinaryState state;
+        CHECK(bank.GetName(i) == presets[(std::size_t) i].name);
+        CHECK(bank.ReadPreset(i, state));
+        CHECK(IsEqual(state, presets[(std::size_t) i].state));
+    }
+}
+
+TEST(PresetBankFile, EmptyBank)
+{
+    const auto bytes = PresetBankFile::Write({});
+    PresetBankFile bank;
+    CHECK(bank.Open(bytes.data(), bytes.size()));
+    CHECK(bank.GetNumPresets() == 0);
+}
+
+TEST(PresetBankFile, OutOfRange)
+{
+    const auto bytes = PresetBankFile::Write(CreatePresets());
+    PresetBankFile bank;
+    CHECK(bank.Open(bytes.data(), bytes.size()));
+    BinaryState state;
+    CHECK(! bank.ReadPreset(-1, state));
+    CHECK(! bank.ReadPreset(bank.GetNumPresets(), state));
+    CHECK(bank.GetName(bank.GetNumPresets()).empty());
+}
+
+// the records end at the end of the bank, so a bank that is cut off does not open
+TEST(PresetBankFile, Truncated)
+{
+    const auto bytes = PresetBankFile::Write(CreatePresets());
+    for(std::size_t size=0;size<bytes.size();size++)
+    {
+        PresetBankFile bank;
+        CHECK(! bank.Open(bytes.data(), size));
+        CHECK(bank.GetNumPresets() == 0);
+    }
+}
+
+// a damaged bank either does not open, or its records can be read without reading outside of it
+TEST(PresetBankFile, Corrupted)
+{
+    const auto bytes = PresetBankFile::Write(CreatePresets());
+    for(std::size_t bit=0;bit<bytes.size()*8;bit++)
+    {
+        const auto damaged = Tests::FlipBit(bytes, bit);
+        PresetBankFile bank;
+        if(bank.Open(damaged.data(), damaged.size()))
+        {
+            ReadAll(bank);
+        }
+    }
+}
+
+TEST(PresetBankFile, UnknownData)
+{
+    auto bytes = PresetBankFile::Write(CreatePresets());
+    bytes[4] = (std::uint8_t) (PresetBankFile::FormatVersion + 1);
+    PresetBankFile bank;
+    CHECK(! bank.Open(bytes.data(), bytes.size()));
+
+    // a plugin state is not a bank
+    BinaryState state;
+    std::vector<std::uint8_t> stateBytes(state.GetSize());
+    state.Write(stateBytes.data());
+    CHECK(! PresetBankFile::IsPresetBank(stateBytes.data(), stateBytes.size()));
+    CHECK(! bank.Open(stateBytes.data(), stateBytes.size()));
+    CHECK(! bank.Open(nullptr, 0));
+}
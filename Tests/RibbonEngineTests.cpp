@@ -0,0 +1,427 @@
+/*
+  ==============================================================================
+
+    RibbonEngineTests.cpp
+    Created: 18 Oct 2026 6:05:21pm
+    Author:  PJP
+
+    Feeds ribbon cc values to the engine and checks the notes it plays.
+
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <vector>
+#include "EngineParameters.h"
+#include "RibbonEngine.h"
+#include "Tests.h"
+
+namespace
+{
+const int BlockSize = 128;
+
+// a triad in every zone of every progression
+EngineSettings CreateSettings()
+{
+    auto settings = EngineParameters::CreateDefault().settings;
+    for(int prog=0;prog<MAX_PROGRESSIONS;prog++)
+    {
+        for(int zone=0;zone<MAX_ZONES;zone++)
+        {
+            settings.chords.chordNotes.Set(prog, zone, 1, 4);
+            settings.chords.chordNotes.Set(prog, zone, 2, 7);
+        }
+    }
+    return settings;
+}
+
+// the first cc value of the zone
+int ValueOfZone(const EngineConfig& config, int zone)
+{
+    for(int value=0;value<128;value++)
+    {
+        if(config.zones.ZoneForValue(value) == zone) return value;
+    }
+    return -1;
+}
+
+// the notes of the chord of the zone, with the note offset
+std::vector<int> ChordOf(const EngineConfig& config, int zone, int noteOffset = 0)
+{
+    std::vector<int> notes;
+    for(int j=0;j<MAX_NOTES && config.chords.notes[0][zone-1][j]!=NONOTE;j++)
+    {
+        notes.push_back(config.chords.notes[0][zone-1][j] + noteOffset);
+    }
+    return notes;
+}
+
+// what a synth would hear: the notes that are on, and every event in order
+struct Synth
+{
+    bool isOn[16][128] = {};
+    std::vector<MidiEvent> events;
+
+    void operator()(const MidiEvent& event, int samplePosition)
+    {
+        auto played = event;
+        played.samplePosition = samplePosition;
+        events.push_back(played);
+        const auto status = event.data[0] & 0xf0;
+        if(status == 0x90 || status == 0x80)
+        {
+            isOn[event.data[0] & 0x0f][event.data[1]] = status == 0x90 && event.data[2] > 0;
+        }
+    }
+
+    int CountSounding() const
+    {
+        int count = 0;
+        for(const auto& channel : isOn)
+            for(auto on : channel)
+                count += on ? 1 : 0;
+        return count;
+    }
+
+    // exactly these notes are sounding on the channel
+    bool IsPlaying(const std::vector<int>& notes, int channel = 1) const
+    {
+        for(int note=0;note<128;note++)
+        {
+            const bool inChord = std::find(notes.begin(), notes.end(), note) != notes.end();
+            if(isOn[channel - 1][note] != inChord) return false;
+        }
+        return CountSounding() == (int) notes.size();
+    }
+
+    // note ons with a velocity, and note offs in either style, from the given event on
+    int CountNoteOns(std::size_t from = 0) const
+    {
+        int count = 0;
+        for(auto i=from;i<events.size();i++)
+            count += (events[i].data[0] & 0xf0) == 0x90 && events[i].data[2] > 0 ? 1 : 0;
+        return count;
+    }
+    int CountNoteOffs(std::size_t from = 0) const
+    {
+        int count = 0;
+        for(auto i=from;i<events.size();i++)
+            count += (events[i].data[0] & 0xf0) == 0x80 || ((events[i].data[0] & 0xf0) == 0x90 && events[i].data[2] == 0) ? 1 : 0;
+        return count;
+    }
+};
+
+struct EngineRun
+{
+    EngineConfig config;
+    DeliveryPolicy policy;
+    RibbonEngine engine;
+    Synth synth;
+
+    explicit EngineRun(const EngineSettings& settings = CreateSettings())
+    {
+        EngineConfig::Compile(settings, config);
+        engine.Prepare(48000.0, BlockSize);
+    }
+
+    // one block with the given cc values, evenly over the block
+    void Block(std::initializer_list<int> values = {})
+    {
+        engine.BeginBlock(config, 0, 100, policy);
+        int position = 0;
+        for(auto value : values)
+        {
+            const std::uint8_t data[3] = {0xb0, (std::uint8_t) config.midiCC, (std::uint8_t) value};
+            engine.HandleMidi(data, 3, position);
+            position += BlockSize / (int) values.size();
+        }
+        engine.EndBlock(BlockSize, synth);
+    }
+};
+}
+
+// the Patchwork policy holds back note offs of a chord change in the queue. A bypass must still
+// pass them on, or the notes hang.
+TEST(RibbonEngine, FlushPassesQueuedNoteOffs)
+{
+    EngineRun run;
+    run.policy = {DeliveryMode::eventsPerBlock, 1, 64, 256};
+    run.Block({ValueOfZone(run.config, 1)});
+    run.Block();
+    run.Block();
+    CHECK(run.synth.CountSounding() == 3);
+
+    run.Block({ValueOfZone(run.config, 2)});
+    CHECK(! run.engine.GetQueue().isEmpty());
+    run.engine.Flush(BlockSize, run.synth);
+    CHECK(run.synth.CountSounding() == 0);
+    CHECK(run.engine.GetQueue().isEmpty());
+    CHECK(! run.engine.GetSoundingNotes().IsAnySounding());
+    for(const auto& event : run.synth.events)
+    {
+        CHECK(event.samplePosition >= 0 && event.samplePosition < BlockSize);
+    }
+}
+
+// note ons that were not played yet are dropped by a flush, not played
+TEST(RibbonEngine, FlushDropsQueuedNoteOns)
+{
+    EngineRun run;
+    run.policy = {DeliveryMode::eventsPerBlock, 1, 64, 256};
+    run.Block({ValueOfZone(run.config, 1)});
+    const auto numPlayed = run.synth.events.size();
+    run.engine.Flush(BlockSize, run.synth);
+    CHECK(run.synth.CountSounding() == 0);
+    for(auto i=numPlayed;i<run.synth.events.size();i++)
+    {
+        const auto& event = run.synth.events[i];
+        CHECK((event.data[0] & 0xf0) == 0x80 || event.data[2] == 0);
+    }
+}
+
+//==============================================================================
+// Chords
+//==============================================================================
+TEST(RibbonEngine, ChordChange)
+{
+    EngineRun run;
+    run.Block({ValueOfZone(run.config, 1)});
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 1)));
+    CHECK(run.engine.GetActiveZone() == 1);
+
+    // the previous chord is stopped with a note off and a zero velocity note on per note
+    const auto numPlayed = run.synth.events.size();
+    run.Block({ValueOfZone(run.config, 2)});
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 2)));
+    CHECK(run.synth.CountNoteOns(numPlayed) == 3);
+    CHECK(run.synth.CountNoteOffs(numPlayed) == 6);
+
+    // the same zone again plays nothing, zone 0 stops the notes
+    const auto numChanged = run.synth.events.size();
+    run.Block({ValueOfZone(run.config, 2) + 1});
+    CHECK(run.synth.events.size() == numChanged);
+    run.Block({0});
+    CHECK(run.synth.CountSounding() == 0);
+    CHECK(run.engine.GetActiveZone() == 0);
+    CHECK(run.engine.GetOverflowCount() == 0);
+}
+
+// every zone that is crossed within a block is played at the sample of its cc message
+TEST(RibbonEngine, ZonesWithinOneBlock)
+{
+    EngineRun run;
+    run.Block({ValueOfZone(run.config, 1), ValueOfZone(run.config, 2), ValueOfZone(run.config, 3)});
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 3)));
+    CHECK(run.synth.CountNoteOns() == 9);
+    for(std::size_t i=1;i<run.synth.events.size();i++)
+    {
+        CHECK(run.synth.events[i].samplePosition >= run.synth.events[i - 1].samplePosition);
+    }
+    CHECK(run.synth.events.front().samplePosition == 0);
+    CHECK(run.synth.events.back().samplePosition == 2 * (BlockSize / 3));
+}
+
+TEST(RibbonEngine, NoteOffStyle)
+{
+    auto settings = CreateSettings();
+    settings.noteOffStyle = (int) NoteOffStyle::noteOff;
+    EngineRun run(settings);
+    run.Block({ValueOfZone(run.config, 1)});
+    auto numPlayed = run.synth.events.size();
+    run.Block({0});
+    CHECK(run.synth.events.size() - numPlayed == 3);
+    CHECK(run.synth.CountSounding() == 0);
+
+    settings.noteOffStyle = (int) NoteOffStyle::zeroVelocityNoteOn;
+    EngineRun zeroVelocityRun(settings);
+    zeroVelocityRun.Block({ValueOfZone(zeroVelocityRun.config, 1)});
+    numPlayed = zeroVelocityRun.synth.events.size();
+    zeroVelocityRun.Block({0});
+    for(auto i=numPlayed;i<zeroVelocityRun.synth.events.size();i++)
+    {
+        CHECK(zeroVelocityRun.synth.events[i].data[0] == 0x90 && zeroVelocityRun.synth.events[i].data[2] == 0);
+    }
+    CHECK(zeroVelocityRun.synth.CountSounding() == 0);
+}
+
+TEST(RibbonEngine, Channels)
+{
+    auto settings = CreateSettings();
+    settings.channelIn = 2;
+    settings.channelOut = 5;
+    EngineRun run(settings);
+    run.Block({ValueOfZone(run.config, 1)});
+    CHECK(run.synth.events.empty());
+
+    run.engine.BeginBlock(run.config, 0, 100, run.policy);
+    const std::uint8_t data[3] = {0xb1, (std::uint8_t) run.config.midiCC, (std::uint8_t) ValueOfZone(run.config, 1)};
+    CHECK(run.engine.HandleMidi(data, 3, 0));
+    const std::uint8_t other[3] = {0xb1, (std::uint8_t) (run.config.midiCC + 1), 64};
+    CHECK(! run.engine.HandleMidi(other, 3, 0));
+    run.engine.EndBlock(BlockSize, run.synth);
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 1), 5));
+}
+
+// notes that both chords have in common keep sounding without a retrigger
+TEST(RibbonEngine, Legato)
+{
+    auto settings = CreateSettings();
+    settings.legato = true;
+    EngineRun run(settings);
+    // the chords of the first zone and the zone a third above share one note
+    int zone = 2;
+    std::vector<int> common;
+    for(;zone<=DEFAULT_NUMBEROFZONES && common.empty();zone++)
+    {
+        for(auto note : ChordOf(run.config, zone))
+        {
+            const auto first = ChordOf(run.config, 1);
+            if(std::find(first.begin(), first.end(), note) != first.end()) common.push_back(note);
+        }
+    }
+    zone--;
+    CHECK(! common.empty());
+
+    run.Block({ValueOfZone(run.config, 1)});
+    const auto numPlayed = run.synth.events.size();
+    run.Block({ValueOfZone(run.config, zone)});
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, zone)));
+    const auto numChanged = (int) (3 - common.size());
+    CHECK(run.synth.CountNoteOns(numPlayed) == numChanged);
+    CHECK(run.synth.CountNoteOffs(numPlayed) == 2 * numChanged);
+    for(auto i=numPlayed;i<run.synth.events.size();i++)
+    {
+        CHECK(std::find(common.begin(), common.end(), run.synth.events[i].data[1]) == common.end());
+    }
+}
+
+//==============================================================================
+// Zones
+//==============================================================================
+// a noisy ribbon at a boundary does not chatter between the chords
+TEST(RibbonEngine, Hysteresis)
+{
+    auto settings = CreateSettings();
+    settings.hysteresis = 2;
+    EngineRun run(settings);
+    const auto boundary = ValueOfZone(run.config, 2);
+    run.Block({boundary - 3});
+    const auto numPlayed = run.synth.events.size();
+    run.Block({boundary, boundary - 1, boundary + 1, boundary - 2, boundary});
+    CHECK(run.synth.events.size() == numPlayed);
+    CHECK(run.engine.GetActiveZone() == 1);
+    run.Block({boundary + 2});
+    CHECK(run.engine.GetActiveZone() == 2);
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 2)));
+}
+
+// a zone is only played when the ribbon stays in it for the minimum dwell time. Releasing is not delayed.
+TEST(RibbonEngine, MinimumDwell)
+{
+    auto settings = CreateSettings();
+    settings.minimumDwellMs = 5; // 240 samples
+    EngineRun run(settings);
+    run.Block({ValueOfZone(run.config, 1)});
+    run.Block();
+    run.Block();
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 1)));
+
+    // passing through zone 2 on the way to zone 3
+    run.Block({ValueOfZone(run.config, 2), ValueOfZone(run.config, 3)});
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 1)));
+    run.Block();
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 1)));
+    const auto numPlayed = run.synth.events.size();
+    run.Block();
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 3)));
+    // zone 3 was selected at sample 64 of the block two blocks ago
+    CHECK(run.synth.events[numPlayed].samplePosition == 64 + 240 - 2 * BlockSize);
+
+    run.Block({0});
+    CHECK(run.synth.CountSounding() == 0);
+    CHECK(run.synth.events.back().samplePosition == 0);
+}
+
+//==============================================================================
+// Transpose and octave shift
+//==============================================================================
+// the offset is heard from the next chord on, sounding notes keep their pitch
+TEST(RibbonEngine, NoteOffset)
+{
+    EngineRun run;
+    run.Block({ValueOfZone(run.config, 1)});
+    run.engine.SetNoteOffset(12 + 3);
+    run.Block();
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 1)));
+    run.Block({ValueOfZone(run.config, 2)});
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 2, 12 + 3)));
+    run.Block({0});
+    CHECK(run.synth.CountSounding() == 0);
+
+    // notes outside of the midi range are not played
+    run.engine.SetNoteOffset(127 - ChordOf(run.config, 1)[1]);
+    run.Block({ValueOfZone(run.config, 1)});
+    CHECK(run.synth.CountSounding() == 2);
+}
+
+// a learned transpose or octave shift control changes the offset of the next chord
+TEST(RibbonEngine, LearnedNoteOffset)
+{
+    auto parameters = EngineParameters::CreateDefault();
+    parameters.transposeControl = {1, 0, 20, 0, 128};
+    parameters.octaveShiftControl = {1, 0, 21, 0, 127};
+    const std::uint8_t transpose[3] = {0xb0, 20, 127};
+    const std::uint8_t octaveDown[3] = {0xb0, 21, 0};
+    CHECK(parameters.ApplyLearnedControl(transpose, 3));
+    CHECK(parameters.transpose == MAX_TRANSPOSE);
+    CHECK(parameters.ApplyLearnedControl(octaveDown, 3));
+    CHECK(parameters.octaveShift == -MAX_OCTAVESHIFT);
+    CHECK(parameters.GetNoteOffset() == MAX_TRANSPOSE - 12 * MAX_OCTAVESHIFT);
+
+    EngineRun run;
+    run.engine.SetNoteOffset(parameters.GetNoteOffset());
+    run.Block({ValueOfZone(run.config, 1)});
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 1, parameters.GetNoteOffset())));
+}
+
+//==============================================================================
+// Delivery
+//==============================================================================
+// a long sweep with one event per block does not grow the backlog, and no event is later than the latency
+TEST(RibbonEngine, SweepWithEventsPerBlock)
+{
+    EngineRun run;
+    run.policy = {DeliveryMode::eventsPerBlock, 1, 64, 0};
+    const auto latency = DeliveryScheduler::getLatencySamples(run.policy, BlockSize);
+    for(int block=0;block<200;block++)
+    {
+        const auto zone = 1 + block % DEFAULT_NUMBEROFZONES;
+        run.engine.BeginBlock(run.config, 0, 100, run.policy);
+        const std::uint8_t data[3] = {0xb0, (std::uint8_t) run.config.midiCC, (std::uint8_t) ValueOfZone(run.config, zone)};
+        run.engine.HandleMidi(data, 3, 0);
+        const auto numPlayed = run.synth.events.size();
+        CHECK(run.engine.EndBlock(BlockSize, run.synth) <= latency);
+        CHECK(run.synth.events.size() - numPlayed <= 1);
+        CHECK(run.engine.GetQueue().size() <= MAX_EVENTS_PER_CHANGE);
+    }
+    for(int block=0;block<MAX_EVENTS_PER_CHANGE;block++)
+    {
+        run.Block();
+    }
+    CHECK(run.engine.GetQueue().isEmpty());
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 1 + 199 % DEFAULT_NUMBEROFZONES)));
+    CHECK(run.engine.GetOverflowCount() == 0);
+}
+
+// a config of another preset stops the notes of the previous one
+TEST(RibbonEngine, PresetChange)
+{
+    EngineRun run;
+    run.Block({ValueOfZone(run.config, 1)});
+    run.config.preset.serial++;
+    run.Block();
+    CHECK(run.synth.CountSounding() == 0);
+    CHECK(run.engine.GetActiveZone() == 0);
+    run.Block({ValueOfZone(run.config, 1)});
+    CHECK(run.synth.IsPlaying(ChordOf(run.config, 1)));
+}
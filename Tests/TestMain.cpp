@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    TestMain.cpp
+    Created: 18 Oct 2026 3:26:40pm
+    Author:  PJP
+
+    Usage: RibbonTests [<group>]
+
+  ==============================================================================
+*/
+
+#include <cstdio>
+#include <cstring>
+#include "Tests.h"
+
+namespace
+{
+int numFailures = 0;
+}
+
+std::vector<Tests::Test>& Tests::GetTests()
+{
+    static std::vector<Test> tests;
+    return tests;
+}
+
+void Tests::Fail(const char* file, int line, const char* condition)
+{
+    std::fprintf(stderr, "  %s:%d: CHECK(%s) failed\n", file, line, condition);
+    numFailures++;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* group = argc > 1 ? argv[1] : nullptr;
+    int numTests = 0, numFailedTests = 0;
+    for(const auto& test : Tests::GetTests())
+    {
+        if(group != nullptr && std::strcmp(group, test.group) != 0) continue;
+        const auto failuresBefore = numFailures;
+        test.function();
+        numTests++;
+        if(numFailures != failuresBefore)
+        {
+            std::fprintf(stderr, "FAILED %s.%s\n", test.group, test.name);
+            numFailedTests++;
+        }
+    }
+    if(numTests == 0)
+    {
+        std::fprintf(stderr, "RibbonTests: no tests in group %s\n", group != nullptr ? group : "(all)");
+        return 1;
+    }
+    std::printf("RibbonTests: %d tests, %d failed\n", numTests, numFailedTests);
+    return numFailedTests == 0 ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    Tests.h
+    Created: 18 Oct 2026 3:26:40pm
+    Author:  PJP
+
+    A small test registry for the JUCE-free code. A test is a function in a
+    group; CHECK reports a failed condition and the test goes on. The tests
+    of one group are run by RibbonTests <group>, see CMakeLists.txt.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Tests
+{
+struct Test
+{
+    const char* group;
+    const char* name;
+    void (*function)();
+};
+
+std::vector<Test>& GetTests();
+void Fail(const char* file, int line, const char* condition);
+
+struct Registration
+{
+    Registration(const char* group, const char* name, void (*function)()) { GetTests().push_back({group, name, function}); }
+};
+
+// the bytes with one bit flipped, for the tests of damaged data
+inline std::vector<std::uint8_t> FlipBit(std::vector<std::uint8_t> bytes, std::size_t bit)
+{
+    bytes[bit / 8] = (std::uint8_t) (bytes[bit / 8] ^ (1u << (bit % 8)));
+    return bytes;
+}
+}
+
+#define TEST(group, name) \
+    static void group##_##name(); \
+    static const Tests::Registration group##_##name##_registration(#group, #name, group##_##name); \
+    static void group##_##name()
+
+#define CHECK(condition) \
+    do { if(! (condition)) Tests::Fail(__FILE__, __LINE__, #condition); } while(false)
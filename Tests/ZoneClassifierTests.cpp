@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    ZoneClassifierTests.cpp
+    Created: 18 Oct 2026 7:44:19pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "ZoneClassifier.h"
+#include "Tests.h"
+
+namespace
+{
+// zone 0 is 0..10, zone 1 11..39, zone 2 40..79, zone 3 80..99, above is no zone
+ZoneClassifier CreateClassifier(int hysteresis)
+{
+    const int splitValues[MAX_SPLITS] = {10, 40, 80, 100, 128, 128, 128, 128, 128};
+    ZoneClassifier classifier;
+    classifier.Build(splitValues, 3, hysteresis);
+    return classifier;
+}
+}
+
+TEST(ZoneClassifier, ZoneForValue)
+{
+    const auto classifier = CreateClassifier(0);
+    CHECK(classifier.ZoneForValue(0) == 0);
+    CHECK(classifier.ZoneForValue(10) == 0);
+    CHECK(classifier.ZoneForValue(11) == 1);
+    CHECK(classifier.ZoneForValue(39) == 1);
+    CHECK(classifier.ZoneForValue(40) == 2);
+    CHECK(classifier.ZoneForValue(99) == 3);
+    CHECK(classifier.ZoneForValue(100) == NOZONE);
+    CHECK(classifier.ZoneForValue(127) == NOZONE);
+    CHECK(classifier.Classify(45, 1) == 2);
+}
+
+// the current zone is kept until the value is more than the hysteresis outside of it
+TEST(ZoneClassifier, Hysteresis)
+{
+    const auto classifier = CreateClassifier(3);
+    CHECK(classifier.Classify(42, 1) == 1);
+    CHECK(classifier.Classify(43, 1) == 2);
+    CHECK(classifier.Classify(37, 2) == 2);
+    CHECK(classifier.Classify(36, 2) == 1);
+    // a zone that is not next to the current one is selected right away
+    CHECK(classifier.Classify(80, 1) == 3);
+    // from no zone and to zone 0 or no zone there is no hysteresis
+    CHECK(classifier.Classify(42, 0) == 2);
+    CHECK(classifier.Classify(10, 1) == 0);
+    CHECK(classifier.Classify(100, 3) == NOZONE);
+}
+
+// a band is never as wide as the zones next to it, so a narrow zone is still played
+TEST(ZoneClassifier, NarrowZone)
+{
+    // zone 2 is 40..43
+    const int splitValues[MAX_SPLITS] = {10, 40, 44, 100, 128, 128, 128, 128, 128};
+    ZoneClassifier classifier;
+    classifier.Build(splitValues, 3, 10);
+    CHECK(classifier.GetBand(1) == 3);
+    CHECK(classifier.GetBand(2) == 3);
+    CHECK(classifier.GetBand(3) == 0);
+    CHECK(classifier.Classify(42, 1) == 1);
+    CHECK(classifier.Classify(43, 1) == 2);
+    CHECK(classifier.Classify(41, 3) == 3);
+    CHECK(classifier.Classify(40, 3) == 2);
+    CHECK(classifier.Classify(36, 2) == 1);
+}
+
+// every boundary has its own band
+TEST(ZoneClassifier, BandPerBoundary)
+{
+    const int splitValues[MAX_SPLITS] = {10, 40, 80, 100, 128, 128, 128, 128, 128};
+    const int bands[MAX_SPLITS] = {5, 2, 6, 5, 5, 5, 5, 5, 5};
+    ZoneClassifier classifier;
+    classifier.Build(splitValues, 3, bands);
+    CHECK(classifier.GetBand(1) == 2);
+    CHECK(classifier.GetBand(2) == 6);
+    CHECK(classifier.Classify(41, 1) == 1);
+    CHECK(classifier.Classify(42, 1) == 2);
+    CHECK(classifier.Classify(38, 2) == 2);
+    CHECK(classifier.Classify(37, 2) == 1);
+    CHECK(classifier.Classify(85, 2) == 2);
+    CHECK(classifier.Classify(86, 2) == 3);
+    CHECK(classifier.Classify(74, 3) == 3);
+    CHECK(classifier.Classify(73, 3) == 2);
+    // zone 0 is not delayed by the band of the first boundary
+    CHECK(classifier.Classify(10, 1) == 0);
+}
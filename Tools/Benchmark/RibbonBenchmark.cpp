@@ -0,0 +1,389 @@
+/*
+  ==============================================================================
+
+    RibbonBenchmark.cpp
+    Created: 17 Oct 2026 7:02:36pm
+    Author:  PJP
+
+    Measures the audio path of the plugin: the ribbon engine is driven block
+    by block with the same calls processBlock makes, for a sweep of block
+    sizes, sample rates, ribbon densities, zone counts, chord sizes and
+    delivery policies. Fails when an event is delayed by more than the
+    latency of its delivery policy.
+
+    Usage:
+      RibbonBenchmark [--quick] [--seconds <audio seconds per case>] [--output <file.json>]
+      RibbonBenchmark --compare <before.json> <after.json>
+
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "RibbonEngine.h"
+
+namespace
+{
+//==============================================================================
+// Ribbon traffic
+//==============================================================================
+struct RibbonEvent
+{
+    std::int64_t sample;
+    int value;
+};
+
+struct Density
+{
+    const char* name;
+    double ccPerSecond;   // rate of the cc messages while the ribbon is touched
+    double touchSeconds;  // length of a touch, 0 = touched all the time
+    double touchesPerSecond;
+};
+
+const Density densities[] =
+{
+    {"sparse",   200.0,  0.05, 2.0},  // a short touch now and then
+    {"touches",  200.0,  0.25, 2.0},  // playing chords
+    {"sweep100", 100.0,  0.0,  0.0},  // continuous sweep, 100 cc/s
+    {"sweep1k",  1000.0, 0.0,  0.0},  // continuous sweep, 1 kHz
+};
+
+// triangle sweep over the whole ribbon, released (value 0) at the end of every touch
+std::vector<RibbonEvent> CreateRibbonEvents(const Density& density, double sampleRate, double seconds)
+{
+    std::vector<RibbonEvent> events;
+    auto totalSamples = (std::int64_t) (sampleRate * seconds);
+    auto ccInterval = sampleRate / density.ccPerSecond;
+    auto touchInterval = density.touchesPerSecond > 0 ? sampleRate / density.touchesPerSecond : 0.0;
+    auto touchLength = (std::int64_t) (density.touchSeconds * sampleRate);
+
+    int step = 0;
+    for(double time = 0; time < totalSamples; time += ccInterval, step++)
+    {
+        auto sample = (std::int64_t) time;
+        if(touchInterval > 0)
+        {
+            auto inTouch = sample - (std::int64_t) (std::int64_t (sample / touchInterval) * touchInterval);
+            if(inTouch > touchLength) continue;
+            if(inTouch + ccInterval > touchLength)
+            {
+                events.push_back({sample, 0});
+                continue;
+            }
+        }
+        auto phase = step % 254;
+        events.push_back({sample, 1 + (phase < 127 ? phase : 253 - phase)});
+    }
+    return events;
+}
+
+struct NamedPolicy
+{
+    const char* name; // added to the name of the case, empty for all at once
+    DeliveryPolicy policy;
+};
+
+const NamedPolicy policies[] =
+{
+    {"", {DeliveryMode::allAtOnce, 1, 64, 0}},
+    {"_perblock1", {DeliveryMode::eventsPerBlock, 1, 64, 256}}, // Blue Cat's Patchwork
+    {"_spread64", {DeliveryMode::spreadOverSamples, 1, 64, 0}},
+};
+
+//==============================================================================
+// Engine settings
+//==============================================================================
+void CreateConfig(int numberOfZones, int chordSize, EngineConfig& config)
+{
+    EngineSettings settings {};
+    settings.midiCC = 22;
+    settings.numberOfZones = numberOfZones;
+    settings.splitValues[0] = 4;
+    for(int i=1;i<MAX_SPLITS;i++)
+    {
+        settings.splitValues[i] = 4 + i * 123 / numberOfZones;
+    }
+    settings.channelIn = 0;
+    settings.channelOut = 0;
+    settings.hysteresis = 0;
+    settings.minimumDwellMs = 0;
+    settings.legato = false;
+    settings.noteOffStyle = 0;
+    settings.chords.octave = 0;
+    settings.chords.pitchMode = 0;
+    for(int prog=0;prog<MAX_PROGRESSIONS;prog++)
+    {
+        for(int zone=0;zone<MAX_ZONES;zone++)
+        {
+            settings.chords.keys[prog][zone] = 1 + (zone * 5) % 12;
+            for(int note=0;note<MAX_NOTES;note++)
+            {
+                settings.chords.chordNotes.Set(prog, zone, note, note < chordSize ? note * 4 : NONOTE);
+            }
+        }
+    }
+    EngineConfig::Compile(settings, config);
+}
+
+//==============================================================================
+// Measurement
+//==============================================================================
+struct Case
+{
+    int blockSize;
+    double sampleRate;
+    const Density* density;
+    int numberOfZones;
+    int chordSize;
+    const NamedPolicy* policy;
+
+    std::string getName() const
+    {
+        std::ostringstream name;
+        name << "bs" << blockSize << "_sr" << (int) sampleRate << "_" << density->name
+             << "_z" << numberOfZones << "_n" << chordSize << policy->name;
+        return name.str();
+    }
+};
+
+struct Result
+{
+    std::int64_t blocks = 0;
+    std::int64_t inputEvents = 0;
+    std::int64_t outputEvents = 0;
+    double meanNs = 0;
+    double p50Ns = 0;
+    double p99Ns = 0;
+    double maxNs = 0;
+    double eventsPerSecond = 0;
+    double realtimeFactor = 0;
+    int maxDelaySamples = 0;  // largest delay of an event, measured
+    int latencySamples = 0;   // largest delay the policy allows
+};
+
+double Percentile(const std::vector<double>& sorted, double fraction)
+{
+    if(sorted.empty()) return 0;
+    auto index = (std::size_t) (fraction * (double) (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+Result Run(const Case& benchmarkCase, double seconds)
+{
+    static EngineConfig config;
+    CreateConfig(benchmarkCase.numberOfZones, benchmarkCase.chordSize, config);
+    auto ribbonEvents = CreateRibbonEvents(*benchmarkCase.density, benchmarkCase.sampleRate, seconds);
+
+    RibbonEngine engine;
+    engine.Prepare(benchmarkCase.sampleRate, benchmarkCase.blockSize);
+    const auto& policy = benchmarkCase.policy->policy;
+
+    auto totalSamples = (std::int64_t) (benchmarkCase.sampleRate * seconds);
+    auto numBlocks = (totalSamples + benchmarkCase.blockSize - 1) / benchmarkCase.blockSize;
+    std::vector<double> blockNs;
+    blockNs.reserve((std::size_t) numBlocks);
+
+    Result result;
+    std::size_t next = 0;
+    std::int64_t outputEvents = 0;
+    auto countOutput = [&outputEvents](const MidiEvent&, int) { outputEvents++; };
+    double totalNs = 0;
+
+    for(std::int64_t block=0;block<numBlocks;block++)
+    {
+        auto blockStart = block * benchmarkCase.blockSize;
+        auto blockEnd = blockStart + benchmarkCase.blockSize;
+
+        auto start = std::chrono::steady_clock::now();
+        engine.BeginBlock(config, 0, 100, policy);
+        for(;next < ribbonEvents.size() && ribbonEvents[next].sample < blockEnd;next++)
+        {
+            const std::uint8_t data[3] = {0xb0, 22, (std::uint8_t) ribbonEvents[next].value};
+            engine.HandleMidi(data, 3, (int) (ribbonEvents[next].sample - blockStart));
+            result.inputEvents++;
+        }
+        result.maxDelaySamples = std::max(result.maxDelaySamples, engine.EndBlock(benchmarkCase.blockSize, countOutput));
+        auto end = std::chrono::steady_clock::now();
+
+        auto ns = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        blockNs.push_back(ns);
+        totalNs += ns;
+    }
+
+    std::sort(blockNs.begin(), blockNs.end());
+    result.blocks = numBlocks;
+    result.outputEvents = outputEvents;
+    result.meanNs = numBlocks > 0 ? totalNs / (double) numBlocks : 0;
+    result.p50Ns = Percentile(blockNs, 0.50);
+    result.p99Ns = Percentile(blockNs, 0.99);
+    result.maxNs = blockNs.empty() ? 0 : blockNs.back();
+    result.eventsPerSecond = totalNs > 0 ? (double) (result.inputEvents + result.outputEvents) * 1e9 / totalNs : 0;
+    result.realtimeFactor = totalNs > 0 ? seconds * 1e9 / totalNs : 0;
+    result.latencySamples = DeliveryScheduler::getLatencySamples(policy, benchmarkCase.blockSize);
+    return result;
+}
+
+//==============================================================================
+// Output
+//==============================================================================
+// one case per line, so results can be compared without a json library
+void WriteJson(std::ostream& out, const std::vector<Case>& cases, const std::vector<Result>& results, double seconds)
+{
+    out << "{\n  \"benchmark\": \"RibbonEngine\",\n  \"secondsPerCase\": " << seconds << ",\n  \"cases\": [\n";
+    for(std::size_t i=0;i<cases.size();i++)
+    {
+        const auto& c = cases[i];
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << c.getName() << "\""
+            << ", \"blockSize\": " << c.blockSize
+            << ", \"sampleRate\": " << (int) c.sampleRate
+            << ", \"density\": \"" << c.density->name << "\""
+            << ", \"zones\": " << c.numberOfZones
+            << ", \"chordSize\": " << c.chordSize
+            << ", \"blocks\": " << r.blocks
+            << ", \"inputEvents\": " << r.inputEvents
+            << ", \"outputEvents\": " << r.outputEvents
+            << ", \"meanNsPerBlock\": " << (std::int64_t) r.meanNs
+            << ", \"p50NsPerBlock\": " << (std::int64_t) r.p50Ns
+            << ", \"p99NsPerBlock\": " << (std::int64_t) r.p99Ns
+            << ", \"maxNsPerBlock\": " << (std::int64_t) r.maxNs
+            << ", \"eventsPerSecond\": " << (std::int64_t) r.eventsPerSecond
+            << ", \"realtimeFactor\": " << (std::int64_t) r.realtimeFactor
+            << ", \"maxDelaySamples\": " << r.maxDelaySamples
+            << ", \"latencySamples\": " << r.latencySamples
+            << "}" << (i + 1 < cases.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+bool ReadNumber(const std::string& line, const std::string& key, double& value)
+{
+    auto position = line.find("\"" + key + "\": ");
+    if(position == std::string::npos) return false;
+    value = std::strtod(line.c_str() + position + key.size() + 4, nullptr);
+    return true;
+}
+
+std::map<std::string, double> ReadP50(const char* fileName)
+{
+    std::map<std::string, double> values;
+    std::ifstream file(fileName);
+    std::string line;
+    while(std::getline(file, line))
+    {
+        auto start = line.find("\"name\": \"");
+        double p50;
+        if(start == std::string::npos || !ReadNumber(line, "p50NsPerBlock", p50)) continue;
+        start += 9;
+        values[line.substr(start, line.find('"', start) - start)] = p50;
+    }
+    return values;
+}
+
+// prints the p50 of both runs for every case they have in common
+int Compare(const char* before, const char* after)
+{
+    auto beforeValues = ReadP50(before);
+    auto afterValues = ReadP50(after);
+    if(beforeValues.empty() || afterValues.empty())
+    {
+        std::cerr << "no benchmark results in " << (beforeValues.empty() ? before : after) << "\n";
+        return 1;
+    }
+    std::printf("%-40s %12s %12s %8s\n", "case", "before p50", "after p50", "ratio");
+    for(const auto& [name, value] : beforeValues)
+    {
+        auto found = afterValues.find(name);
+        if(found == afterValues.end()) continue;
+        std::printf("%-40s %12.0f %12.0f %8.2f\n", name.c_str(), value, found->second, value > 0 ? found->second / value : 0.0);
+    }
+    return 0;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    double seconds = 10.0;
+    bool quick = false;
+    const char* outputFile = nullptr;
+
+    for(int i=1;i<argc;i++)
+    {
+        if(std::strcmp(argv[i], "--compare") == 0 && i + 2 < argc)
+        {
+            return Compare(argv[i + 1], argv[i + 2]);
+        }
+        else if(std::strcmp(argv[i], "--quick") == 0)
+        {
+            quick = true;
+            seconds = 1.0;
+        }
+        else if(std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+        {
+            seconds = std::max(0.01, std::atof(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+        {
+            outputFile = argv[++i];
+        }
+        else
+        {
+            std::cerr << "usage: RibbonBenchmark [--quick] [--seconds <s>] [--output <file.json>]\n"
+                         "       RibbonBenchmark --compare <before.json> <after.json>\n";
+            return 1;
+        }
+    }
+
+    const std::vector<int> blockSizes = quick ? std::vector<int>{16, 256, 4096}
+                                              : std::vector<int>{16, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+    const std::vector<double> sampleRates = quick ? std::vector<double>{48000.0}
+                                                  : std::vector<double>{44100.0, 48000.0, 96000.0};
+    const std::vector<int> zoneCounts = {1, DEFAULT_NUMBEROFZONES, MAX_ZONES};
+    const std::vector<int> chordSizes = {1, 4, MAX_NOTES};
+
+    std::vector<Case> cases;
+    for(auto blockSize : blockSizes)
+        for(auto sampleRate : sampleRates)
+            for(const auto& density : densities)
+                for(auto zones : zoneCounts)
+                    for(auto chordSize : chordSizes)
+                        for(const auto& policy : policies)
+                            cases.push_back({blockSize, sampleRate, &density, zones, chordSize, &policy});
+
+    std::vector<Result> results;
+    bool isLatencyBounded = true;
+    for(const auto& benchmarkCase : cases)
+    {
+        results.push_back(Run(benchmarkCase, seconds));
+        const auto& result = results.back();
+        std::cerr << benchmarkCase.getName() << ": p50 " << (std::int64_t) result.p50Ns
+                  << " ns/block, p99 " << (std::int64_t) result.p99Ns << " ns/block\n";
+        if(result.maxDelaySamples > result.latencySamples)
+        {
+            std::cerr << benchmarkCase.getName() << ": an event was delayed by " << result.maxDelaySamples
+                      << " samples, the latency of the policy is " << result.latencySamples << "\n";
+            isLatencyBounded = false;
+        }
+    }
+
+    if(outputFile != nullptr)
+    {
+        std::ofstream file(outputFile);
+        WriteJson(file, cases, results, seconds);
+    }
+    else
+    {
+        WriteJson(std::cout, cases, results, seconds);
+    }
+    return isLatencyBounded ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+/*
+  ==============================================================================
+
+    RealtimeStress.cpp
+    Created: 17 Oct 2026 8:58:21pm
+    Author:  PJP
+
+    Runs the ribbon engine as the audio thread does, with random ribbon
+    traffic, random block sizes and settings, while another thread keeps
+    publishing new engine configs, delivery policies and preset banks. The
+    JUCE-free part of processBlock is done too: program changes that select
+    a preset of the bank, learned controls and the midi that is passed on.
+    Built with RIBBON_REALTIME_AUDIT, so every allocation and lock on the
+    audio thread is counted. Registered with ctest in an audit build.
+
+    Exits with 1 when anything was counted, and prints the call sites.
+
+    Usage: RibbonRealtimeStress [--seconds <wall clock seconds>] [--abort]
+
+  ==============================================================================
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include "PresetBank.h"
+#include "RibbonEngine.h"
+#include "RealtimeAudit.h"
+#include "SnapshotExchange.h"
+
+namespace
+{
+EngineSettings CreateRandomSettings(std::mt19937& random)
+{
+    auto number = [&random](int minimum, int maximum) { return std::uniform_int_distribution<int>(minimum, maximum)(random); };
+
+    EngineSettings settings {};
+    settings.midiCC = 22;
+    settings.numberOfZones = number(1, MAX_ZONES);
+    settings.splitValues[0] = number(0, 10);
+    for(int i=1;i<MAX_SPLITS;i++)
+    {
+        settings.splitValues[i] = std::min(127, settings.splitValues[i-1] + number(1, 127 / settings.numberOfZones));
+    }
+    settings.channelIn = number(0, 1) == 0 ? 0 : number(1, 16);
+    settings.channelOut = number(0, 16);
+    settings.hysteresis = number(0, 4);
+    settings.minimumDwellMs = number(0, 2) == 0 ? number(1, 50) : 0;
+    settings.legato = number(0, 1) == 1;
+    settings.noteOffStyle = number(0, 2);
+    settings.chords.octave = number(-2, 2);
+    settings.chords.pitchMode = number(0, 1);
+    for(int prog=0;prog<MAX_PROGRESSIONS;prog++)
+    {
+        for(int zone=0;zone<MAX_ZONES;zone++)
+        {
+            settings.chords.keys[prog][zone] = number(1, 12);
+            auto chordSize = number(0, MAX_NOTES);
+            for(int note=0;note<MAX_NOTES;note++)
+            {
+                settings.chords.chordNotes.Set(prog, zone, note, note < chordSize ? number(0, 24) : NONOTE);
+            }
+        }
+    }
+    return settings;
+}
+
+// checks that the hooks are active, so a clean run can be trusted
+bool AuditIsActive()
+{
+    RealtimeAudit::Reset();
+    std::mutex mutex;
+    {
+        RIBBON_REALTIME_SECTION();
+        int* volatile value = new int(1); // volatile, so the compiler can not leave the allocation out
+        delete value;
+        mutex.lock();
+        mutex.unlock();
+    }
+    auto counts = RealtimeAudit::GetCounts();
+    RealtimeAudit::Reset();
+    return counts.allocations == 1 && counts.deallocations == 1 && counts.locks == 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    double seconds = 2.0;
+    bool abortOnViolation = false;
+    for(int i=1;i<argc;i++)
+    {
+        if(std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+        {
+            seconds = std::atof(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--abort") == 0)
+        {
+            abortOnViolation = true;
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: RibbonRealtimeStress [--seconds <s>] [--abort]\n");
+            return 1;
+        }
+    }
+
+    if(! RealtimeAudit::IsEnabled() || ! AuditIsActive())
+    {
+        std::fprintf(stderr, "RibbonRealtimeStress: the realtime audit is not active, build with RIBBON_REALTIME_AUDIT=ON\n");
+        return 1;
+    }
+
+    // the configs, policies and banks are published by a second thread, like the message thread does
+    static SnapshotExchange<EngineConfig> configs;
+    static SnapshotExchange<DeliveryPolicy> policies;
+    static SnapshotExchange<std::shared_ptr<const PresetBank>> banks;
+    static EngineConfig initialConfig;
+    std::mt19937 random(1234);
+    EngineConfig::Compile(CreateRandomSettings(random), initialConfig);
+    configs.reset(initialConfig);
+    policies.reset(DeliveryPolicy());
+    banks.reset(nullptr);
+
+    std::atomic<bool> running {true};
+    auto publisherSeed = random();
+    std::thread publisher([&running, publisherSeed]
+    {
+        static EngineConfig config;
+        std::mt19937 publisherRandom(publisherSeed);
+        auto number = [&publisherRandom](int minimum, int maximum) { return std::uniform_int_distribution<int>(minimum, maximum)(publisherRandom); };
+        std::uint32_t serial = 0;
+        for(int round=0;running;round++)
+        {
+            EngineConfig::Compile(CreateRandomSettings(publisherRandom), config);
+            configs.publish(config);
+
+            DeliveryPolicy policy;
+            policy.mode = (DeliveryMode) number(0, 2);
+            policy.eventsPerBlock = number(1, 8);
+            policy.spreadSamples = number(0, 127);
+            policy.maxBlockSize = number(0, 1) * number(1, 4096);
+            policies.publish(policy);
+
+            // the previous bank is released here, never on the audio thread
+            if(round % 50 == 0)
+            {
+                auto bank = std::make_shared<PresetBank>();
+                bank->numPresets = number(0, 8);
+                for(int i=0;i<bank->numPresets;i++)
+                {
+                    EngineConfig::Compile(CreateRandomSettings(publisherRandom), bank->presets[i]);
+                    bank->presets[i].preset = {++serial, number(0, MAX_PROGRESSIONS - 1), (std::uint8_t) number(1, 127),
+                                               number(-MAX_TRANSPOSE, MAX_TRANSPOSE)};
+                }
+                banks.publish(bank);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    const int maxBlockSize = 4096;
+    const double sampleRate = 48000.0;
+    RibbonEngine engine;
+    engine.Prepare(sampleRate, maxBlockSize);
+    // the midi that is passed on, preallocated like thruMessages in prepareToPlay
+    MidiEventQueue thru;
+    thru.prepare(4096);
+    auto parameters = EngineParameters::CreateDefault();
+    parameters.velocityControl.messageType = 1;
+    parameters.transposeControl.messageType = 1;
+    parameters.octaveShiftControl.messageType = 1;
+    RealtimeAudit::SetAbortOnViolation(abortOnViolation);
+
+    std::uniform_int_distribution<int> blockSizes(1, maxBlockSize);
+    std::uniform_int_distribution<int> values(0, 127);
+    std::uniform_int_distribution<int> kinds(0, 2);
+    std::uint64_t blocks = 0, inputEvents = 0, outputEvents = 0;
+    auto countOutput = [&outputEvents](const MidiEvent&, int) { outputEvents++; };
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+
+    while(std::chrono::steady_clock::now() < end)
+    {
+        auto numSamples = blockSizes(random);
+        int numEvents = std::uniform_int_distribution<int>(0, std::min(numSamples, 64))(random);
+
+        {
+            RIBBON_REALTIME_SECTION();
+            const auto* bank = banks.acquire().get();
+            engine.BeginBlock(configs.acquire(), (int) (blocks % MAX_PROGRESSIONS), (std::uint8_t) values(random), policies.acquire());
+            engine.SetNoteOffset(parameters.GetNoteOffset());
+            for(int i=0;i<numEvents;i++)
+            {
+                const auto position = i * numSamples / std::max(numEvents, 1);
+                const auto kind = kinds(random);
+                // ribbon, program change or learned control, or midi that is passed on
+                const std::uint8_t status = (std::uint8_t) ((kind == 1 ? 0xc0 : 0xb0) | (values(random) & 0x01));
+                const std::uint8_t number = (std::uint8_t) (kind == 2 ? 11 + values(random) % 6 : kind == 1 ? values(random) % 10 : 22);
+                const std::uint8_t data[3] = {status, number, (std::uint8_t) values(random)};
+                if(engine.HandleMidi(data, 3, position))
+                {
+                    continue;
+                }
+                if(kind == 1 && bank != nullptr && number < bank->numPresets)
+                {
+                    engine.SetConfig(bank->presets[number], position);
+                }
+                else if(parameters.ApplyLearnedControl(data, 3))
+                {
+                    engine.SetVelocity(parameters.GetMidiVelocity());
+                    engine.SetNoteOffset(parameters.GetNoteOffset());
+                }
+                else
+                {
+                    thru.push(MidiEvent::create(data, kind == 1 ? 2 : 3, position));
+                }
+            }
+            outputEvents += (std::uint64_t) thru.size();
+            thru.clear();
+            if(blocks % 1000 == 999)
+            {
+                engine.StopAllSoundingNotes(0);
+            }
+            if(blocks % 5000 == 4999)
+            {
+                engine.Flush(numSamples, countOutput);
+            }
+            else
+            {
+                engine.EndBlock(numSamples, countOutput);
+            }
+        }
+        blocks++;
+        inputEvents += (std::uint64_t) numEvents;
+    }
+
+    running = false;
+    publisher.join();
+
+    std::printf("RibbonRealtimeStress: %llu blocks, %llu ribbon events, %llu notes, %u dropped\n",
+                (unsigned long long) blocks, (unsigned long long) inputEvents,
+                (unsigned long long) outputEvents, engine.GetOverflowCount());
+    RealtimeAudit::PrintReport(stdout);
+    return RealtimeAudit::GetCounts().total() == 0 ? 0 : 1;
+}
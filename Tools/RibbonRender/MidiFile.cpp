@@ -0,0 +1,341 @@
+/*
+  ==============================================================================
+
+    MidiFile.cpp
+    Created: 17 Oct 2026 9:58:37pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "MidiFile.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+const double DefaultSecondsPerQuarterNote = 0.5; // 120 bpm, until the first tempo event
+
+class Reader
+{
+public:
+    Reader(const std::vector<std::uint8_t>& bytes, std::size_t start, std::size_t end) : data(bytes), position(start), end(end) {}
+
+    bool atEnd() const { return position >= end; }
+    bool canRead(std::size_t numBytes) const { return position + numBytes <= end; }
+    std::uint8_t peek() const { return data[position]; }
+    std::uint8_t readByte() { return data[position++]; }
+    std::size_t getPosition() const { return position; }
+    void skip(std::size_t numBytes) { position += numBytes; }
+
+    bool readVariableLength(std::uint32_t& value)
+    {
+        value = 0;
+        for(int i=0;i<4;i++)
+        {
+            if(atEnd()) return false;
+            auto byte = readByte();
+            value = (value << 7) | (byte & 0x7f);
+            if((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+private:
+    const std::vector<std::uint8_t>& data;
+    std::size_t position;
+    std::size_t end;
+};
+
+std::uint32_t ReadBigEndian(const std::vector<std::uint8_t>& bytes, std::size_t position, int numBytes)
+{
+    std::uint32_t value = 0;
+    for(int i=0;i<numBytes;i++)
+    {
+        value = (value << 8) | bytes[position + (std::size_t) i];
+    }
+    return value;
+}
+
+void WriteBigEndian(std::vector<std::uint8_t>& bytes, std::uint32_t value, int numBytes)
+{
+    for(int i=numBytes-1;i>=0;i--)
+    {
+        bytes.push_back((std::uint8_t) (value >> (8 * i)));
+    }
+}
+
+void WriteVariableLength(std::vector<std::uint8_t>& bytes, std::uint32_t value)
+{
+    std::uint8_t buffer[5];
+    int count = 0;
+    buffer[count++] = (std::uint8_t) (value & 0x7f);
+    while((value >>= 7) != 0)
+    {
+        buffer[count++] = (std::uint8_t) (0x80 | (value & 0x7f));
+    }
+    while(count > 0)
+    {
+        bytes.push_back(buffer[--count]);
+    }
+}
+
+int GetNumDataBytes(std::uint8_t status)
+{
+    switch(status & 0xf0)
+    {
+        case 0xc0:
+        case 0xd0: return 1;
+        default:   return 2;
+    }
+}
+
+// reads the events of one track. order counts the events of all tracks, to keep the order of the tracks at equal ticks.
+bool ReadTrack(Reader reader, int track, std::vector<MidiFileEvent>& events, std::vector<std::pair<int, std::size_t>>& order, std::string& error)
+{
+    std::int64_t tick = 0;
+    std::uint8_t runningStatus = 0;
+    std::size_t index = 0;
+    while(! reader.atEnd())
+    {
+        std::uint32_t delta;
+        if(! reader.readVariableLength(delta) || reader.atEnd())
+        {
+            error = "track " + std::to_string(track) + " is truncated";
+            return false;
+        }
+        tick += delta;
+
+        MidiFileEvent event {tick, {}};
+        auto status = reader.peek();
+        if(status == 0xff || status == 0xf0 || status == 0xf7)
+        {
+            reader.readByte();
+            std::uint8_t type = 0;
+            if(status == 0xff)
+            {
+                if(reader.atEnd()) { error = "truncated meta event"; return false; }
+                type = reader.readByte();
+            }
+            std::uint32_t length;
+            if(! reader.readVariableLength(length) || ! reader.canRead(length))
+            {
+                error = "truncated meta or sysex event in track " + std::to_string(track);
+                return false;
+            }
+            event.data.push_back(status);
+            if(status == 0xff) event.data.push_back(type);
+            for(std::uint32_t i=0;i<length;i++) event.data.push_back(reader.readByte());
+            if(status == 0xff && type == 0x2f)
+            {
+                break; // end of track
+            }
+        }
+        else
+        {
+            if(status & 0x80)
+            {
+                runningStatus = reader.readByte();
+            }
+            else if(runningStatus == 0)
+            {
+                error = "data byte without status in track " + std::to_string(track);
+                return false;
+            }
+            auto numDataBytes = GetNumDataBytes(runningStatus);
+            if(! reader.canRead((std::size_t) numDataBytes))
+            {
+                error = "truncated event in track " + std::to_string(track);
+                return false;
+            }
+            event.data.push_back(runningStatus);
+            for(int i=0;i<numDataBytes;i++) event.data.push_back(reader.readByte());
+        }
+        events.push_back(std::move(event));
+        order.emplace_back(track, index++);
+    }
+    return true;
+}
+}
+
+//==============================================================================
+bool MidiFile::Read(const std::string& path, std::string& error)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if(! stream)
+    {
+        error = "can not open " + path;
+        return false;
+    }
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    if(bytes.size() < 14 || std::string(bytes.begin(), bytes.begin() + 4) != "MThd")
+    {
+        error = path + " is not a standard midi file";
+        return false;
+    }
+    auto headerLength = ReadBigEndian(bytes, 4, 4);
+    auto format = ReadBigEndian(bytes, 8, 2);
+    auto numTracks = ReadBigEndian(bytes, 10, 2);
+    rawDivision = (std::uint16_t) ReadBigEndian(bytes, 12, 2);
+    if(format > 1)
+    {
+        error = path + ": midi file format " + std::to_string(format) + " is not supported";
+        return false;
+    }
+    if(rawDivision & 0x8000)
+    {
+        auto framesPerSecond = 256 - (rawDivision >> 8);
+        smpteTicksPerSecond = (framesPerSecond == 29 ? 29.97 : framesPerSecond) * (rawDivision & 0xff);
+        ticksPerQuarterNote = 0;
+    }
+    else
+    {
+        ticksPerQuarterNote = rawDivision;
+    }
+
+    std::vector<MidiFileEvent> trackEvents;
+    std::vector<std::pair<int, std::size_t>> order;
+    std::size_t position = 8 + headerLength;
+    for(std::uint32_t track=0;track<numTracks && position + 8 <= bytes.size();track++)
+    {
+        auto chunkLength = ReadBigEndian(bytes, position + 4, 4);
+        auto chunkStart = position + 8;
+        auto chunkEnd = std::min(bytes.size(), chunkStart + chunkLength);
+        if(std::string(bytes.begin() + (long) position, bytes.begin() + (long) position + 4) == "MTrk")
+        {
+            if(! ReadTrack(Reader(bytes, chunkStart, chunkEnd), (int) track, trackEvents, order, error))
+            {
+                error = path + ": " + error;
+                return false;
+            }
+        }
+        else
+        {
+            track--; // unknown chunks are skipped
+        }
+        position = chunkStart + chunkLength;
+    }
+
+    // merge the tracks
+    std::vector<std::size_t> indexes(trackEvents.size());
+    for(std::size_t i=0;i<indexes.size();i++) indexes[i] = i;
+    std::stable_sort(indexes.begin(), indexes.end(), [&](std::size_t a, std::size_t b)
+    {
+        if(trackEvents[a].tick != trackEvents[b].tick) return trackEvents[a].tick < trackEvents[b].tick;
+        return order[a] < order[b];
+    });
+    events.clear();
+    events.reserve(trackEvents.size());
+    for(auto index : indexes)
+    {
+        events.push_back(std::move(trackEvents[index]));
+    }
+    BuildTempoMap();
+    return true;
+}
+
+bool MidiFile::Write(const std::string& path, std::string& error) const
+{
+    std::vector<std::uint8_t> track;
+    std::int64_t tick = 0;
+    for(const auto& event : events)
+    {
+        if(event.data.empty() || event.isMetaOfType(0x2f)) continue;
+        WriteVariableLength(track, (std::uint32_t) std::max<std::int64_t>(0, event.tick - tick));
+        tick = std::max(tick, event.tick);
+        if(event.isMeta())
+        {
+            track.push_back(0xff);
+            track.push_back(event.data.size() > 1 ? event.data[1] : 0);
+            auto length = event.data.size() > 2 ? event.data.size() - 2 : 0;
+            WriteVariableLength(track, (std::uint32_t) length);
+            track.insert(track.end(), event.data.begin() + (long) (event.data.size() - length), event.data.end());
+        }
+        else if(event.data[0] == 0xf0 || event.data[0] == 0xf7)
+        {
+            track.push_back(event.data[0]);
+            WriteVariableLength(track, (std::uint32_t) (event.data.size() - 1));
+            track.insert(track.end(), event.data.begin() + 1, event.data.end());
+        }
+        else
+        {
+            track.insert(track.end(), event.data.begin(), event.data.end());
+        }
+    }
+    // end of track
+    WriteVariableLength(track, 0);
+    track.push_back(0xff);
+    track.push_back(0x2f);
+    track.push_back(0x00);
+
+    std::vector<std::uint8_t> bytes {'M', 'T', 'h', 'd'};
+    WriteBigEndian(bytes, 6, 4);
+    WriteBigEndian(bytes, 0, 2);    // format 0
+    WriteBigEndian(bytes, 1, 2);    // one track
+    WriteBigEndian(bytes, rawDivision, 2);
+    bytes.insert(bytes.end(), {'M', 'T', 'r', 'k'});
+    WriteBigEndian(bytes, (std::uint32_t) track.size(), 4);
+    bytes.insert(bytes.end(), track.begin(), track.end());
+
+    std::ofstream stream(path, std::ios::binary);
+    if(! stream.write((const char*) bytes.data(), (std::streamsize) bytes.size()))
+    {
+        error = "can not write " + path;
+        return false;
+    }
+    return true;
+}
+
+void MidiFile::SetEvents(std::vector<MidiFileEvent> newEvents)
+{
+    events = std::move(newEvents);
+}
+
+//==============================================================================
+// Tempo map
+//==============================================================================
+void MidiFile::BuildTempoMap()
+{
+    tempoMap.clear();
+    if(smpteTicksPerSecond > 0.0)
+    {
+        tempoMap.push_back({0, 0.0, 1.0 / smpteTicksPerSecond});
+        return;
+    }
+    tempoMap.push_back({0, 0.0, DefaultSecondsPerQuarterNote / ticksPerQuarterNote});
+    for(const auto& event : events)
+    {
+        if(! event.isMetaOfType(0x51) || event.data.size() < 5) continue;
+        auto microsecondsPerQuarterNote = ((std::uint32_t) event.data[2] << 16) | ((std::uint32_t) event.data[3] << 8) | event.data[4];
+        auto secondsPerTick = microsecondsPerQuarterNote * 1.0e-6 / ticksPerQuarterNote;
+        auto& last = tempoMap.back();
+        auto seconds = last.seconds + (double) (event.tick - last.tick) * last.secondsPerTick;
+        if(event.tick == last.tick)
+        {
+            last.secondsPerTick = secondsPerTick;
+        }
+        else
+        {
+            tempoMap.push_back({event.tick, seconds, secondsPerTick});
+        }
+    }
+}
+
+double MidiFile::TickToSeconds(std::int64_t tick) const
+{
+    auto next = std::upper_bound(tempoMap.begin(), tempoMap.end(), tick,
+                                 [](std::int64_t value, const TempoChange& change) { return value < change.tick; });
+    const auto& change = next == tempoMap.begin() ? tempoMap.front() : *(next - 1);
+    return change.seconds + (double) (tick - change.tick) * change.secondsPerTick;
+}
+
+std::int64_t MidiFile::SecondsToTick(double seconds) const
+{
+    auto next = std::upper_bound(tempoMap.begin(), tempoMap.end(), seconds,
+                                 [](double value, const TempoChange& change) { return value < change.seconds; });
+    const auto& change = next == tempoMap.begin() ? tempoMap.front() : *(next - 1);
+    return change.tick + (std::int64_t) std::llround((seconds - change.seconds) / change.secondsPerTick);
+}
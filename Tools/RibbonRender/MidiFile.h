@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    MidiFile.h
+    Created: 17 Oct 2026 9:58:37pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//==============================================================================
+// Event of a standard midi file. data holds the complete message: the status
+// byte and its data bytes, F0 (or F7) and the bytes of a sysex message, or
+// FF, the type and the data of a meta event.
+//==============================================================================
+struct MidiFileEvent
+{
+    std::int64_t tick;
+    std::vector<std::uint8_t> data;
+
+    bool isMeta() const { return ! data.empty() && data[0] == 0xff; }
+    bool isMetaOfType(int type) const { return isMeta() && data.size() > 1 && data[1] == type; }
+};
+
+//==============================================================================
+// Reads standard midi files of format 0 and 1 and writes format 0. The tracks
+// are merged into one list of events, ordered by tick; events at the same tick
+// keep the order of their tracks.
+//==============================================================================
+class MidiFile
+{
+public:
+    bool Read(const std::string& path, std::string& error);
+    bool Write(const std::string& path, std::string& error) const;
+
+    // tempo map, from the tempo meta events of all tracks
+    double TickToSeconds(std::int64_t tick) const;
+    std::int64_t SecondsToTick(double seconds) const;
+
+    int GetTicksPerQuarterNote() const { return ticksPerQuarterNote; }
+    std::vector<MidiFileEvent>& GetEvents() { return events; }
+    const std::vector<MidiFileEvent>& GetEvents() const { return events; }
+
+    // the events are replaced, the timing of the file is kept
+    void SetEvents(std::vector<MidiFileEvent> newEvents);
+
+private:
+    struct TempoChange
+    {
+        std::int64_t tick;
+        double seconds;                 // time of the tick
+        double secondsPerTick;          // from this tick on
+    };
+    void BuildTempoMap();
+
+    int ticksPerQuarterNote = 480;
+    double smpteTicksPerSecond = 0.0;   // > 0 for files with smpte timing
+    std::uint16_t rawDivision = 480;
+    std::vector<MidiFileEvent> events;
+    std::vector<TempoChange> tempoMap;
+};
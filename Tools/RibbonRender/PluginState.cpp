@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    PluginState.cpp
+    Created: 17 Oct 2026 10:21:05pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#include "PluginState.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+namespace
+{
+// magic number of juce::AudioProcessor::copyXmlToBinary, followed by the size of the xml text
+const std::uint32_t StateMagic = 0x21324356;
+
+// value of an attribute of the element between position and end
+bool GetAttribute(const std::string& xml, std::size_t position, std::size_t end, const std::string& name, std::string& value)
+{
+    auto search = " " + name + "=\"";
+    auto start = xml.find(search, position);
+    if(start == std::string::npos || start >= end) return false;
+    start += search.size();
+    auto stop = xml.find('"', start);
+    if(stop == std::string::npos || stop > end) return false;
+    value = xml.substr(start, stop - start);
+    return true;
+}
+
+// the ids of all parameters of the plugin (CreateParameterLayout), by the hash the binary state uses
+std::unordered_map<std::uint32_t, std::string> CreateParameterIDs()
+{
+    std::unordered_map<std::uint32_t, std::string> ids;
+    auto add = [&ids](const char* id) { ids[BinaryState::HashID(id)] = id; };
+    for(auto* id : {MIDICC_ID, NUMBEROFZONES_ID, VELOCITY_ID, OCTAVES_ID, HYSTERESIS_ID, MINIMUMDWELL_ID, LEGATO_ID,
+                    NOTEOFFSTYLE_ID, CHANNELIN_ID, CHANNELOUT_ID, PITCHMODES_ID, ACTIVEPROGRESSION_ID,
+                    MIDIINMESSAGETYPE_ID VELOCITY_ID, MIDIINCHANNEL_ID VELOCITY_ID, MIDIINNUMBER_ID VELOCITY_ID,
+                    MIDIINMINVALUE_ID VELOCITY_ID, MIDIINMAXVALUE_ID VELOCITY_ID, TRANSPOSE_ID, OCTAVESHIFT_ID,
+                    MIDIINMESSAGETYPE_ID TRANSPOSE_ID, MIDIINCHANNEL_ID TRANSPOSE_ID, MIDIINNUMBER_ID TRANSPOSE_ID,
+                    MIDIINMINVALUE_ID TRANSPOSE_ID, MIDIINMAXVALUE_ID TRANSPOSE_ID,
+                    MIDIINMESSAGETYPE_ID OCTAVESHIFT_ID, MIDIINCHANNEL_ID OCTAVESHIFT_ID, MIDIINNUMBER_ID OCTAVESHIFT_ID,
+                    MIDIINMINVALUE_ID OCTAVESHIFT_ID, MIDIINMAXVALUE_ID OCTAVESHIFT_ID})
+    {
+        add(id);
+    }
+    for(int i=0;i<MAX_SPLITS;i++)
+    {
+        add(GetParameterID(ParameterKind::splits, i));
+    }
+    for(int prog=0;prog<MAX_PROGRESSIONSKNOBS;prog++)
+    {
+        for(int i=0;i<MAX_ZONES && prog<MAX_PROGRESSIONS;i++)
+        {
+            add(GetParameterID(ParameterKind::keys, prog, i));
+            add(GetParameterID(ParameterKind::chords, prog, i));
+        }
+        add(GetParameterID(ParameterKind::midiInMessageTypeProgression, prog));
+        add(GetParameterID(ParameterKind::midiInChannelProgression, prog));
+        add(GetParameterID(ParameterKind::midiInNumberProgression, prog));
+        add(GetParameterID(ParameterKind::midiInMinValueProgression, prog));
+        add(GetParameterID(ParameterKind::midiInMaxValueProgression, prog));
+    }
+    return ids;
+}
+
+int GetIntAttribute(const std::string& xml, std::size_t position, std::size_t end, const std::string& name, int defaultValue)
+{
+    std::string value;
+    return GetAttribute(xml, position, end, name, value) ? std::atoi(value.c_str()) : defaultValue;
+}
+}
+
+//==============================================================================
+bool PluginState::Read(const std::string& path, std::string& error)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if(! stream)
+    {
+        error = "can not open " + path;
+        return false;
+    }
+    std::string bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    BinaryState binaryState;
+    if(binaryState.Read(bytes.data(), bytes.size()))
+    {
+        if(! ReadBinary(binaryState, error))
+        {
+            error = path + ": " + error;
+            return false;
+        }
+        return true;
+    }
+    if(BinaryState::IsBinaryState(bytes.data(), bytes.size()))
+    {
+        error = path + ": unknown plugin state version";
+        return false;
+    }
+
+    if(bytes.size() >= 8)
+    {
+        auto magic = (std::uint32_t) (std::uint8_t) bytes[0] | (std::uint32_t) (std::uint8_t) bytes[1] << 8
+                   | (std::uint32_t) (std::uint8_t) bytes[2] << 16 | (std::uint32_t) (std::uint8_t) bytes[3] << 24;
+        if(magic == StateMagic)
+        {
+            auto size = (std::uint32_t) (std::uint8_t) bytes[4] | (std::uint32_t) (std::uint8_t) bytes[5] << 8
+                      | (std::uint32_t) (std::uint8_t) bytes[6] << 16 | (std::uint32_t) (std::uint8_t) bytes[7] << 24;
+            bytes = bytes.substr(8, size);
+        }
+    }
+    if(! ReadXml(bytes, error))
+    {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+bool PluginState::ReadBinary(const BinaryState& state, std::string& error)
+{
+    static const auto parameterIDs = CreateParameterIDs();
+    for(const auto& parameter : state.parameters)
+    {
+        auto id = parameterIDs.find(parameter.idHash);
+        if(id != parameterIDs.end())
+        {
+            parameters.SetParameter(id->second, parameter.value);
+        }
+    }
+    if(! state.chordBuilds.empty() && ! parameters.settings.chords.chordNotes.FromBytes(state.chordBuilds.data(), state.chordBuilds.size()))
+    {
+        error = "unknown chord build version";
+        return false;
+    }
+    deliveryPolicy = state.deliveryPolicy;
+    hasDeliveryPolicy = true;
+    return true;
+}
+
+bool PluginState::ReadXml(const std::string& xml, std::string& error)
+{
+    if(xml.find('<') == std::string::npos)
+    {
+        error = "not a preset or plugin state";
+        return false;
+    }
+    // parameters first: chord builds of older versions are parameters, they are replaced by the property
+    std::size_t position = 0;
+    while((position = xml.find("<PARAM ", position)) != std::string::npos)
+    {
+        auto end = xml.find('>', position);
+        if(end == std::string::npos) break;
+        std::string id, value;
+        if(GetAttribute(xml, position, end, "id", id) && GetAttribute(xml, position, end, "value", value))
+        {
+            parameters.SetParameter(id, std::strtof(value.c_str(), nullptr));
+        }
+        position = end;
+    }
+
+    // the root element holds the properties of the state
+    auto root = xml.find('<');
+    while(root != std::string::npos && root + 1 < xml.size() && (xml[root + 1] == '?' || xml[root + 1] == '!'))
+    {
+        root = xml.find('<', root + 1);
+    }
+    if(root != std::string::npos)
+    {
+        std::string chordBuilds;
+        auto end = xml.find('>', root);
+        if(GetAttribute(xml, root, end, CHORDBUILDS_ID, chordBuilds)
+           && ! parameters.settings.chords.chordNotes.FromState(chordBuilds))
+        {
+            error = "unknown chord build version";
+            return false;
+        }
+    }
+
+    auto delivery = xml.find("<" DELIVERY_TAG " ");
+    if(delivery != std::string::npos)
+    {
+        auto end = xml.find('>', delivery);
+        deliveryPolicy.mode = (DeliveryMode) std::min(2, std::max(0, GetIntAttribute(xml, delivery, end, "mode", (int) deliveryPolicy.mode)));
+        deliveryPolicy.eventsPerBlock = GetIntAttribute(xml, delivery, end, "eventsPerBlock", deliveryPolicy.eventsPerBlock);
+        deliveryPolicy.spreadSamples = GetIntAttribute(xml, delivery, end, "spreadSamples", deliveryPolicy.spreadSamples);
+        deliveryPolicy.maxBlockSize = GetIntAttribute(xml, delivery, end, "maxBlockSize", deliveryPolicy.maxBlockSize);
+        hasDeliveryPolicy = true;
+    }
+    return true;
+}
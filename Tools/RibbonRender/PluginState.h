@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    PluginState.h
+    Created: 17 Oct 2026 10:21:05pm
+    Author:  PJP
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <string>
+#include "BinaryState.h"
+#include "EngineParameters.h"
+#include "DeliveryScheduler.h"
+
+//==============================================================================
+// Reads the parameters of the plugin from a preset file (the xml written by the
+// PresetManager) or from a state blob (the BinaryState of getStateInformation,
+// or the xml state of older versions, which also hold the delivery policy).
+// Parameters that are not in the file keep their default value.
+//==============================================================================
+struct PluginState
+{
+    EngineParameters parameters = EngineParameters::CreateDefault();
+    DeliveryPolicy deliveryPolicy;
+    bool hasDeliveryPolicy = false;
+
+    bool Read(const std::string& path, std::string& error);
+    bool ReadXml(const std::string& xml, std::string& error);
+    bool ReadBinary(const BinaryState& state, std::string& error);
+};
@@ -0,0 +1,326 @@
+/*
+  ==============================================================================
+
+    RibbonRender.cpp
+    Created: 17 Oct 2026 10:36:50pm
+    Author:  PJP
+
+    Renders standard midi files with recorded ribbon cc through the ribbon
+    engine, block by block with the same calls processBlock makes, and writes
+    the midi the plugin would output. A directory is rendered file by file by
+    a pool of worker threads, one per core by default.
+
+    The plugin reports no latency, so nothing is compensated: notes that the
+    delivery policy delays are written late, as a host records them. At the
+    end of a file the transport stops, which stops the notes that are still
+    sounding.
+
+    Usage:
+      RibbonRender [options] <input.mid> <output.mid>
+      RibbonRender [options] <input directory> <output directory>
+
+    Options:
+      --preset <file>         preset (.preset) or saved plugin state
+      --sample-rate <hz>      default 48000
+      --block-size <samples>  default 512
+      --delivery <policy>     all, perblock:<events> or spread:<samples>,
+                              default the policy of the state, or all
+      --jobs <threads>        default the number of cores
+
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RibbonEngine.h"
+#include "EngineParameters.h"
+#include "MidiFile.h"
+#include "PluginState.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+struct RenderSettings
+{
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+    DeliveryPolicy deliveryPolicy;
+    EngineParameters parameters;
+    const EngineConfig* config = nullptr;
+};
+
+struct RenderResult
+{
+    std::uint64_t inputEvents = 0;
+    std::uint64_t outputEvents = 0;
+    std::uint32_t droppedEvents = 0;
+};
+
+struct Job
+{
+    fs::path input;
+    fs::path output;
+};
+
+//==============================================================================
+// Render
+//==============================================================================
+bool RenderFile(const Job& job, const RenderSettings& settings, RenderResult& result, std::string& error)
+{
+    MidiFile midiFile;
+    if(! midiFile.Read(job.input.string(), error)) return false;
+
+    const auto& input = midiFile.GetEvents();
+    auto toSample = [&](std::int64_t tick) { return (std::int64_t) std::llround(midiFile.TickToSeconds(tick) * settings.sampleRate); };
+
+    // output of the plugin, at the sample of the plugin. Meta events are not midi the plugin sees, they keep their tick.
+    struct OutputEvent
+    {
+        std::int64_t sample;
+        std::int64_t tick;          // >= 0 when the event keeps its tick
+        std::vector<std::uint8_t> data;
+    };
+    std::vector<OutputEvent> output;
+    output.reserve(input.size() * 2);
+
+    auto parameters = settings.parameters;
+    RibbonEngine engine;
+    engine.Prepare(settings.sampleRate, settings.blockSize);
+    auto addEngineEvent = [&](std::int64_t blockStart)
+    {
+        return [&output, blockStart](const MidiEvent& event, int position)
+        {
+            output.push_back({blockStart + position, -1, std::vector<std::uint8_t>(event.data, event.data + event.size)});
+        };
+    };
+
+    std::size_t next = 0;
+    std::int64_t blockStart = 0;
+    bool stopped = false;
+    while(! stopped || ! engine.GetQueue().isEmpty())
+    {
+        engine.BeginBlock(*settings.config, parameters.activeProgression, parameters.GetMidiVelocity(), settings.deliveryPolicy);
+        engine.SetNoteOffset(parameters.GetNoteOffset());
+
+        // transport stop after the last event
+        if(next == input.size() && ! stopped)
+        {
+            engine.StopAllSoundingNotes(0);
+            stopped = true;
+        }
+
+        auto blockEnd = blockStart + settings.blockSize;
+        for(;next < input.size() && toSample(input[next].tick) < blockEnd;next++)
+        {
+            const auto& event = input[next];
+            if(event.isMeta())
+            {
+                output.push_back({toSample(event.tick), event.tick, event.data});
+                continue;
+            }
+            result.inputEvents++;
+            auto position = (int) (toSample(event.tick) - blockStart);
+            if(engine.HandleMidi(event.data.data(), (int) event.data.size(), position))
+            {
+                continue;
+            }
+            if(parameters.ApplyLearnedControl(event.data.data(), (int) event.data.size()))
+            {
+                engine.SetActiveProgression(parameters.activeProgression);
+                engine.SetVelocity(parameters.GetMidiVelocity());
+                engine.SetNoteOffset(parameters.GetNoteOffset());
+            }
+            else
+            {
+                output.push_back({blockStart + position, event.tick, event.data});
+            }
+        }
+        engine.EndBlock(settings.blockSize, addEngineEvent(blockStart));
+        blockStart = blockEnd;
+    }
+    result.droppedEvents = engine.GetOverflowCount();
+
+    // back to ticks
+    std::vector<MidiFileEvent> events;
+    events.reserve(output.size());
+    for(auto& event : output)
+    {
+        auto tick = event.tick >= 0 ? event.tick
+                                    : midiFile.SecondsToTick((double) event.sample / settings.sampleRate);
+        events.push_back({std::max<std::int64_t>(0, tick), std::move(event.data)});
+    }
+    std::stable_sort(events.begin(), events.end(), [](const MidiFileEvent& a, const MidiFileEvent& b) { return a.tick < b.tick; });
+    result.outputEvents = (std::uint64_t) std::count_if(events.begin(), events.end(), [](const MidiFileEvent& event) { return ! event.isMeta(); });
+    midiFile.SetEvents(std::move(events));
+
+    if(job.output.has_parent_path())
+    {
+        std::error_code ignored;
+        fs::create_directories(job.output.parent_path(), ignored);
+    }
+    return midiFile.Write(job.output.string(), error);
+}
+
+//==============================================================================
+// Command line
+//==============================================================================
+bool IsMidiFile(const fs::path& path)
+{
+    auto extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+    return extension == ".mid" || extension == ".midi" || extension == ".smf";
+}
+
+bool ParseDeliveryPolicy(const std::string& text, DeliveryPolicy& policy)
+{
+    if(text == "all")
+    {
+        policy.mode = DeliveryMode::allAtOnce;
+    }
+    else if(text.rfind("perblock:", 0) == 0)
+    {
+        policy.mode = DeliveryMode::eventsPerBlock;
+        policy.eventsPerBlock = std::atoi(text.c_str() + 9);
+        return policy.eventsPerBlock > 0;
+    }
+    else if(text.rfind("spread:", 0) == 0)
+    {
+        policy.mode = DeliveryMode::spreadOverSamples;
+        policy.spreadSamples = std::atoi(text.c_str() + 7);
+        return policy.spreadSamples >= 0;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+int PrintUsage()
+{
+    std::fprintf(stderr, "usage: RibbonRender [--preset <file>] [--sample-rate <hz>] [--block-size <samples>]\n"
+                         "                    [--delivery all|perblock:<events>|spread:<samples>] [--jobs <threads>]\n"
+                         "                    <input.mid|input directory> <output.mid|output directory>\n");
+    return 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    RenderSettings settings;
+    PluginState state;
+    std::string deliveryText;
+    int numJobs = (int) std::thread::hardware_concurrency();
+    std::vector<std::string> paths;
+
+    for(int i=1;i<argc;i++)
+    {
+        auto hasValue = i + 1 < argc;
+        if(std::strcmp(argv[i], "--preset") == 0 && hasValue)
+        {
+            std::string error;
+            if(! state.Read(argv[++i], error))
+            {
+                std::fprintf(stderr, "RibbonRender: %s\n", error.c_str());
+                return 1;
+            }
+        }
+        else if(std::strcmp(argv[i], "--sample-rate") == 0 && hasValue) settings.sampleRate = std::atof(argv[++i]);
+        else if(std::strcmp(argv[i], "--block-size") == 0 && hasValue) settings.blockSize = std::atoi(argv[++i]);
+        else if(std::strcmp(argv[i], "--delivery") == 0 && hasValue) deliveryText = argv[++i];
+        else if(std::strcmp(argv[i], "--jobs") == 0 && hasValue) numJobs = std::atoi(argv[++i]);
+        else if(argv[i][0] == '-') return PrintUsage();
+        else paths.push_back(argv[i]);
+    }
+    if(paths.size() != 2 || settings.sampleRate <= 0.0 || settings.blockSize <= 0) return PrintUsage();
+
+    settings.deliveryPolicy = state.hasDeliveryPolicy ? state.deliveryPolicy : DeliveryPolicy();
+    if(! deliveryText.empty() && ! ParseDeliveryPolicy(deliveryText, settings.deliveryPolicy)) return PrintUsage();
+
+    // one config for all files, it is only read while rendering
+    settings.parameters = state.parameters;
+    auto config = std::make_unique<EngineConfig>();
+    EngineConfig::Compile(settings.parameters.settings, *config);
+    settings.config = config.get();
+
+    // the files to render
+    std::vector<Job> jobs;
+    fs::path input(paths[0]), output(paths[1]);
+    std::error_code error;
+    if(fs::is_directory(input, error))
+    {
+        for(const auto& entry : fs::recursive_directory_iterator(input, error))
+        {
+            if(entry.is_regular_file() && IsMidiFile(entry.path()))
+            {
+                jobs.push_back({entry.path(), output / fs::relative(entry.path(), input)});
+            }
+        }
+        std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.input < b.input; });
+    }
+    else
+    {
+        jobs.push_back({input, output});
+    }
+    if(jobs.empty())
+    {
+        std::fprintf(stderr, "RibbonRender: no midi files in %s\n", paths[0].c_str());
+        return 1;
+    }
+
+    // worker threads take the next file until all files are done
+    std::atomic<std::size_t> nextJob {0};
+    std::atomic<std::uint64_t> inputEvents {0}, outputEvents {0};
+    std::atomic<int> failures {0};
+    auto start = std::chrono::steady_clock::now();
+    auto work = [&]
+    {
+        for(auto index = nextJob++; index < jobs.size(); index = nextJob++)
+        {
+            RenderResult result;
+            std::string message;
+            if(! RenderFile(jobs[index], settings, result, message))
+            {
+                std::fprintf(stderr, "RibbonRender: %s\n", message.c_str());
+                failures++;
+                continue;
+            }
+            if(result.droppedEvents > 0)
+            {
+                std::fprintf(stderr, "RibbonRender: %s: %u events dropped\n", jobs[index].input.string().c_str(), result.droppedEvents);
+            }
+            inputEvents += result.inputEvents;
+            outputEvents += result.outputEvents;
+        }
+    };
+    numJobs = std::max(1, std::min(numJobs, (int) jobs.size()));
+    std::vector<std::thread> workers;
+    for(int i=1;i<numJobs;i++)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("RibbonRender: %zu files, %llu events in, %llu events out, %d failed, %.3f s on %d threads\n",
+                jobs.size() - (std::size_t) failures.load(), (unsigned long long) inputEvents.load(),
+                (unsigned long long) outputEvents.load(), failures.load(), seconds, numJobs);
+    return failures == 0 ? 0 : 1;
+}
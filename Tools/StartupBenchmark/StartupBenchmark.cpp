@@ -0,0 +1,194 @@
+/*
+  ==============================================================================
+
+    StartupBenchmark.cpp
+    Created: 17 Oct 2026 11:52:09pm
+    Author:  PJP
+
+    Measures the part of opening a session that does not depend on JUCE, for
+    a number of plugin instances: creating and binding the parameter ids
+    (the compile time table and binding by hash, against building them with
+    std::to_string),
+    compiling the engine config and reading the chord builds of a state.
+
+    The times of the plugin itself (constructor, setStateInformation and
+    createEditor, including JUCE) are measured by building the plugin with
+    RIBBON_STARTUP_PROFILE=1, see Source/Engine/StartupProfile.h.
+
+    Usage: RibbonStartupBenchmark [--instances <n>] [--rounds <n>]
+
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BinaryState.h"
+#include "ChordBuilds.h"
+#include "EngineConfig.h"
+#include "EngineParameters.h"
+#include "ParameterIDs.h"
+
+namespace
+{
+// stands in for the parameter lookup of juce::AudioProcessorValueTreeState, a map ordered by id
+using ParameterMap = std::map<std::string, float, std::less<>>;
+
+//==============================================================================
+// The ids as they were built before the table: nested std::to_string concatenations
+//==============================================================================
+template <typename Function>
+void ForEachIdWithStrings(Function&& function)
+{
+    for(int prog=0;prog<MAX_PROGRESSIONSKNOBS;prog++)
+    {
+        if(prog<MAX_PROGRESSIONS)
+        {
+            for(int i=0;i<MAX_ZONES;i++)
+            {
+                function(KEYS_ID + std::to_string(prog) + "_" + std::to_string(i));
+                function(CHORDS_ID + std::to_string(prog) + "_" + std::to_string(i));
+            }
+        }
+        function(MIDIINMESSAGETYPE_ID PROGRESSION + std::to_string(prog));
+        function(MIDIINCHANNEL_ID PROGRESSION + std::to_string(prog));
+        function(MIDIINNUMBER_ID PROGRESSION + std::to_string(prog));
+        function(MIDIINMINVALUE_ID PROGRESSION + std::to_string(prog));
+        function(MIDIINMAXVALUE_ID PROGRESSION + std::to_string(prog));
+    }
+    for(int i=0;i<MAX_SPLITS;i++)
+    {
+        function(SPLITS_ID + std::to_string(i));
+    }
+}
+
+template <typename Function>
+void ForEachIdFromTable(Function&& function)
+{
+    for(int prog=0;prog<MAX_PROGRESSIONSKNOBS;prog++)
+    {
+        if(prog<MAX_PROGRESSIONS)
+        {
+            for(int i=0;i<MAX_ZONES;i++)
+            {
+                function(GetParameterID(ParameterKind::keys, prog, i));
+                function(GetParameterID(ParameterKind::chords, prog, i));
+            }
+        }
+        for(int kind=(int) ParameterKind::midiInMessageTypeProgression;kind<=(int) ParameterKind::midiInMaxValueProgression;kind++)
+        {
+            function(GetParameterID((ParameterKind) kind, prog));
+        }
+    }
+    for(int i=0;i<MAX_SPLITS;i++)
+    {
+        function(GetParameterID(ParameterKind::splits, i));
+    }
+}
+
+double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// creates the parameters of one instance, then binds every parameter twice: once in the
+// constructor and once for the attachments of the editor. With the table the constructor
+// binds by the hash of the id, like the processor does
+double RunInstance(bool useTable, float& checksum)
+{
+    auto start = std::chrono::steady_clock::now();
+    ParameterMap parameters;
+    if(useTable)
+    {
+        ForEachIdFromTable([&](const char* id) { parameters.emplace(id, 0.0f); });
+        std::vector<std::pair<std::uint32_t, float*>> hashes;
+        hashes.reserve(parameters.size());
+        for(auto& parameter : parameters)
+        {
+            hashes.emplace_back(BinaryState::HashID(parameter.first.c_str()), &parameter.second);
+        }
+        std::sort(hashes.begin(), hashes.end());
+        ForEachIdFromTable([&](const char* id)
+        {
+            checksum += *std::lower_bound(hashes.begin(), hashes.end(), std::make_pair(BinaryState::HashID(id), (float*) nullptr))->second;
+        });
+        ForEachIdFromTable([&](const char* id) { checksum += parameters.find(id)->second; });
+    }
+    else
+    {
+        ForEachIdWithStrings([&](std::string id) { parameters.emplace(std::move(id), 0.0f); });
+        for(int bind=0;bind<2;bind++)
+        {
+            ForEachIdWithStrings([&](const std::string& id) { checksum += parameters.find(id)->second; });
+        }
+    }
+    return Milliseconds(start);
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int numInstances = 40;
+    int rounds = 20;
+    for(int i=1;i<argc;i++)
+    {
+        if(std::strcmp(argv[i], "--instances") == 0 && i + 1 < argc) numInstances = std::max(1, std::atoi(argv[++i]));
+        else if(std::strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) rounds = std::max(1, std::atoi(argv[++i]));
+        else
+        {
+            std::fprintf(stderr, "usage: RibbonStartupBenchmark [--instances <n>] [--rounds <n>]\n");
+            return 1;
+        }
+    }
+
+    int numIds = 0;
+    ForEachIdFromTable([&numIds](const char*) { numIds++; });
+
+    // the best round of each, so the numbers do not depend on what else the machine is doing
+    float checksum = 0.0f;
+    double bestStrings = 1.0e9, bestTable = 1.0e9;
+    for(int round=0;round<rounds;round++)
+    {
+        double strings = 0.0, table = 0.0;
+        for(int instance=0;instance<numInstances;instance++)
+        {
+            strings += RunInstance(false, checksum);
+            table += RunInstance(true, checksum);
+        }
+        bestStrings = std::min(bestStrings, strings);
+        bestTable = std::min(bestTable, table);
+    }
+
+    // the JUCE-free work of every instance: the default config, then the chord builds of a state.
+    // These are not the stages of StartupProfile, which measure the plugin including JUCE
+    auto state = ChordBuilds::CreateDefault().ToState();
+    double defaultConfig = 0.0, stateConfig = 0.0;
+    for(int instance=0;instance<numInstances;instance++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto parameters = EngineParameters::CreateDefault();
+        auto config = std::make_unique<EngineConfig>();
+        EngineConfig::Compile(parameters.settings, *config);
+        defaultConfig += Milliseconds(start);
+
+        start = std::chrono::steady_clock::now();
+        parameters.settings.chords.chordNotes.FromState(state);
+        EngineConfig::Compile(parameters.settings, *config);
+        stateConfig += Milliseconds(start);
+        checksum += (float) config->chords.notes[0][0][0];
+    }
+
+    std::printf("RibbonStartupBenchmark: %d instances, %d indexed parameter ids each (checksum %g)\n", numInstances, numIds, (double) checksum);
+    std::printf("  ids with std::to_string  %8.3f ms  %8.2f us per instance\n", bestStrings, bestStrings * 1000.0 / numInstances);
+    std::printf("  ids from the table       %8.3f ms  %8.2f us per instance\n", bestTable, bestTable * 1000.0 / numInstances);
+    std::printf("  default engine config    %8.3f ms  %8.2f us per instance\n", defaultConfig, defaultConfig * 1000.0 / numInstances);
+    std::printf("  chord builds of a state  %8.3f ms  %8.2f us per instance\n", stateConfig, stateConfig * 1000.0 / numInstances);
+    return 0;
+}